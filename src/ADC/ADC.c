@@ -18,6 +18,43 @@
 
 #include "ADC.h"
 
+/** @brief SADC0/SADC1 setup of one ADC channel. */
+typedef struct
+{
+    unsigned char sadc0;
+    unsigned char sadc1;
+} ADCChannelSetup;
+
+// Channel setup of every channel, indexed by channel number.
+// Channels disabled with USE_ADC_* hold ADC_CHANNEL_DISABLED.
+static const ADCChannelSetup adcChannelTable[ADC_NUMBER_OF_CHANNELS] = {
+    ADC_TABLE_AN0, ADC_TABLE_AN1, ADC_TABLE_AN2, ADC_TABLE_AN3,
+    ADC_TABLE_VBGREF, ADC_TABLE_OPA0O, ADC_TABLE_OPA1O, ADC_TABLE_LINEV
+};
+
+#if USE_ADC_OVERSAMPLING
+// Oversampling n of every channel, indexed by channel number
+const unsigned char ADCOversampleBits[ADC_NUMBER_OF_CHANNELS] = {
+    ADC_OVERSAMPLE_AN0, ADC_OVERSAMPLE_AN1, ADC_OVERSAMPLE_AN2, ADC_OVERSAMPLE_AN3,
+    ADC_OVERSAMPLE_VBGREF, ADC_OVERSAMPLE_OPA0O, ADC_OVERSAMPLE_OPA1O, ADC_OVERSAMPLE_LINEV
+};
+#endif
+
+// Settling steps of every channel, indexed by channel number
+static const unsigned char adcSettleSteps[ADC_NUMBER_OF_CHANNELS] = {
+    ADC_SETTLE_STEPS(ADC_SETTLE_CYCLES_AN0), ADC_SETTLE_STEPS(ADC_SETTLE_CYCLES_AN1),
+    ADC_SETTLE_STEPS(ADC_SETTLE_CYCLES_AN2), ADC_SETTLE_STEPS(ADC_SETTLE_CYCLES_AN3),
+    ADC_SETTLE_STEPS(ADC_SETTLE_CYCLES_VBGREF), ADC_SETTLE_STEPS(ADC_SETTLE_CYCLES_OPA0O),
+    ADC_SETTLE_STEPS(ADC_SETTLE_CYCLES_OPA1O), ADC_SETTLE_STEPS(ADC_SETTLE_CYCLES_LINEV)
+};
+
+static unsigned char adcInterruptOwned; // 1 while the scan sequencer or the timer trigger drives the ADC
+
+#if USE_ADC_BURST_MODE
+static unsigned char adcBurstActive;                  // 1 between ADCBurstBegin() and ADCBurstEnd()
+static unsigned char adcBurstChannel = ADC_NO_CHANNEL; // Channel currently routed to the ADC
+#endif
+
 /**
  * @brief Initialize the ADC module.
  * 
@@ -33,6 +70,222 @@ void ADCInit()
     _ade = 0; // Disable analog interrupt initially
 }
 
+/**
+ * @brief Route the ADC input multiplexer to a channel.
+ * 
+ * This function writes the channel setup (SADC0/SADC1) for the requested
+ * channel from the ROM channel table without starting a conversion.
+ * Every channel costs the same table lookup. The write also sets ADCEN,
+ * so the converter is powered on.
+ * 
+ * @param channel The ADC channel to select (AN0, AN1, AN2, AN3, VBGREF, OPA0O, OPA1O, LINEV).
+ * @return 1 if the channel was selected, 0 if the channel is invalid or disabled.
+ */
+unsigned char ADCSetChannel(unsigned char channel)
+{
+    unsigned char sadc0;
+
+    if (channel >= ADC_NUMBER_OF_CHANNELS)
+    {
+        return 0; // Invalid channel
+    }
+
+    sadc0 = adcChannelTable[channel].sadc0;
+    if (sadc0 == ADC_CHANNEL_DISABLED)
+    {
+        return 0; // Channel disabled with USE_ADC_*
+    }
+
+    _sadc1 = adcChannelTable[channel].sadc1;
+    _sadc0 = sadc0;
+    return 1;
+}
+
+/**
+ * @brief Wait for a channel's settling delay (ADC_SETTLE_CYCLES_*).
+ * 
+ * For callers that route the multiplexer with ADCSetChannel() and start the
+ * conversion themselves, such as the scan sequencer.
+ * 
+ * @param channel The ADC channel that was just selected.
+ */
+void ADCSettleChannel(unsigned char channel)
+{
+    unsigned char steps;
+
+    if (channel >= ADC_NUMBER_OF_CHANNELS)
+    {
+        return; // Invalid channel
+    }
+
+    for (steps = adcSettleSteps[channel]; steps; steps--)
+    {
+        GCC_DELAY(ADC_SETTLE_STEP_CYCLES);
+    }
+}
+
+/**
+ * @brief Time taken by a channel switch and one conversion.
+ * 
+ * A conversion lasts 16 ADC clocks and the ADC clock is fSYS / 2^ACKS
+ * (SADC1 bits 2..0), which is (4 << ACKS) instruction cycles of fSYS / 4.
+ * The channel's settling delay is added. Call and polling overhead is not.
+ * 
+ * @param channel The ADC channel.
+ * @return The time in instruction cycles, or 0 if the channel is invalid.
+ */
+unsigned int ADCConversionCycles(unsigned char channel)
+{
+    if (channel >= ADC_NUMBER_OF_CHANNELS)
+    {
+        return 0; // Invalid channel
+    }
+
+    return (4U << (adcChannelTable[channel].sadc1 & 0x07)) +
+           (unsigned int)adcSettleSteps[channel] * ADC_SETTLE_STEP_CYCLES;
+}
+
+/**
+ * @brief Take the ADC for an interrupt-driven user.
+ *
+ * The scan sequencer and the timer trigger both run from the ADC interrupt
+ * and each would take the other's results, so only one may own the ADC.
+ *
+ * @return 1 if the ADC was free and is now owned, 0 if it is already owned.
+ */
+unsigned char ADCInterruptClaim(void)
+{
+    if (adcInterruptOwned)
+    {
+        return 0;
+    }
+    adcInterruptOwned = 1;
+    return 1;
+}
+
+/**
+ * @brief Give the ADC back after ADCInterruptClaim().
+ */
+void ADCInterruptRelease(void)
+{
+    adcInterruptOwned = 0;
+}
+
+/**
+ * @brief Check whether an interrupt-driven user owns the ADC.
+ *
+ * @return 1 while the scan sequencer or the timer trigger runs, 0 otherwise.
+ */
+unsigned char ADCInterruptBusy(void)
+{
+    return adcInterruptOwned;
+}
+
+#if USE_ADC_BURST_MODE
+/**
+ * @brief Start a burst of conversions with the ADC kept powered.
+ * 
+ * The ADC is switched on once here; the ReadADC functions then leave it on
+ * and only pay a channel's settling delay when the channel changes.
+ */
+void ADCBurstBegin(void)
+{
+    ADC_ON;
+    GCC_DELAY(12); // Let the converter power up
+    adcBurstChannel = ADC_NO_CHANNEL;
+    adcBurstActive = 1;
+}
+
+/**
+ * @brief End a burst of conversions and power the ADC off.
+ */
+void ADCBurstEnd(void)
+{
+    adcBurstActive = 0;
+    ADC_OFF;
+}
+#endif
+
+/**
+ * @brief Check whether a channel setup has to be written.
+ * 
+ * Inside a burst the setup is skipped when the channel is already routed
+ * to the ADC. Outside a burst the setup is always written.
+ * 
+ * @param channel The ADC channel about to be read.
+ * @return 1 if the caller must write the channel setup and call ADCSettle().
+ */
+static unsigned char ADCNeedsSetup(unsigned char channel)
+{
+#if USE_ADC_BURST_MODE
+    if (adcBurstActive && (channel == adcBurstChannel))
+    {
+        return 0; // Already routed and settled
+    }
+#else
+    (void)channel;
+#endif
+    return 1;
+}
+
+/**
+ * @brief Wait for the input to settle after a channel setup was written.
+ * 
+ * Inside a burst the channel's own settling delay is applied. Outside a burst
+ * the fixed power-up delay is applied, as the converter has just been switched on.
+ * 
+ * @param channel The ADC channel whose setup was written.
+ * @param steps The channel's settling delay in GCC_DELAY(ADC_SETTLE_STEP_CYCLES) steps.
+ */
+static void ADCSettle(unsigned char channel, unsigned char steps)
+{
+#if USE_ADC_BURST_MODE
+    if (adcBurstActive)
+    {
+        adcBurstChannel = channel;
+        for (; steps; steps--)
+        {
+            GCC_DELAY(ADC_SETTLE_STEP_CYCLES);
+        }
+        return;
+    }
+#else
+    (void)channel;
+    (void)steps;
+#endif
+    GCC_DELAY(12); // Small delay to stabilize the signal
+}
+
+/**
+ * @brief Run one conversion on the selected channel.
+ * 
+ * @return The digital value of the conversion.
+ */
+static unsigned int ADCConvert(void)
+{
+    // Start ADC conversion
+    ADC_START_CONVERSION;
+    
+    // Wait for conversion to complete
+    while (_adbz);
+    
+    return ADC_GET_RESULT();
+}
+
+/**
+ * @brief Power the ADC off after a read, unless a burst is running.
+ */
+static void ADCRelease(void)
+{
+#if USE_ADC_BURST_MODE
+    if (adcBurstActive)
+    {
+        return;
+    }
+#endif
+    ADC_OFF; // Disable ADC after conversion
+}
+
 /**
  * @brief Read analog value from a specified ADC channel.
  * 
@@ -46,73 +299,103 @@ unsigned int ReadADC(unsigned char channel)
 {
     unsigned int result;
     
- switch(channel)
- {
-	#if USE_ADC_AN0
-        case AN0:
-            READ_ADC_SET_AN0;
-            break;
-	#endif
-	#if USE_ADC_AN1
-        case AN1:
-            READ_ADC_SET_AN1;
-            break;
-	#endif
-	#if USE_ADC_AN2
-        case AN2:
-            READ_ADC_SET_AN2;
-            break;
-	#endif
-	#if USE_ADC_AN3
-        case AN3:
-            READ_ADC_SET_AN3;
-            break;
-	#endif
-	#if USE_ADC_VBGREF
-        case VBGREF:
-            READ_ADC_SET_VBGREF;
-            break;
-	#endif
-	#if USE_ADC_OPA0O
-        case OPA0O:
-            READ_ADC_SET_OPA0O;
-            break;
-	#endif
-	#if USE_ADC_OPA1O
-        case OPA1O:
-            READ_ADC_SET_OPA1O;
-            break;
-	#endif
-	#if USE_ADC_LINEV
-        case LINEV:
-            READ_ADC_SET_LINEV;
-            break;
-	#endif
-        default:
-           return 0; // Invalid channel
-           break;
-   }
-    
-    // Start ADC conversion
-    ADC_ON;
-    GCC_DELAY(12); // Small delay to stabilize the signal
-    _start = 0;    // Clear start bit
-    _start = 1;    // Set start bit to begin conversion
-    _start = 0;    // Clear start bit again
-    
-    // Wait for conversion to complete
-    while (_adbz);
-    
-    // Disable ADC after conversion
-    ADC_OFF;
-    
-    // Read result based on resolution
-    if( _adrfs == 1)
-    {   
-     result =((_sadol))|((_sadoh<<8));
+    if (ADCNeedsSetup(channel))
+    {
+        if (!ADCSetChannel(channel))
+        {
+            return 0; // Invalid channel
+        }
+        ADCSettle(channel, adcSettleSteps[channel]);
     }
-    else {
-	result =((_sadol>>4))|((_sadoh<<4));
-     }
+    
+    result = ADCConvert();
+    ADCRelease();
     return result; // Return the digital value
 }
+
+/**
+ * @brief Define a fixed-channel read function ReadADC_<name>().
+ * 
+ * The channel setup is written with READ_ADC_SET_<name>, so the compiler
+ * emits immediate register writes and no table lookup.
+ */
+#define ADC_DEFINE_FIXED_READ(name)                                         \
+unsigned int ReadADC_##name(void)                                           \
+{                                                                           \
+    unsigned int result;                                                    \
+                                                                            \
+    if (ADCNeedsSetup(name))                                                \
+    {                                                                       \
+        READ_ADC_SET_##name;                                                \
+        ADCSettle(name, ADC_SETTLE_STEPS(ADC_SETTLE_CYCLES_##name));        \
+    }                                                                       \
+                                                                            \
+    result = ADCConvert();                                                  \
+    ADCRelease();                                                           \
+    return result;                                                          \
+}
+
+#if USE_ADC_AN0
+ADC_DEFINE_FIXED_READ(AN0)
+#endif
+#if USE_ADC_AN1
+ADC_DEFINE_FIXED_READ(AN1)
+#endif
+#if USE_ADC_AN2
+ADC_DEFINE_FIXED_READ(AN2)
+#endif
+#if USE_ADC_AN3
+ADC_DEFINE_FIXED_READ(AN3)
+#endif
+#if USE_ADC_VBGREF
+ADC_DEFINE_FIXED_READ(VBGREF)
+#endif
+#if USE_ADC_OPA0O
+ADC_DEFINE_FIXED_READ(OPA0O)
+#endif
+#if USE_ADC_OPA1O
+ADC_DEFINE_FIXED_READ(OPA1O)
+#endif
+#if USE_ADC_LINEV
+ADC_DEFINE_FIXED_READ(LINEV)
+#endif
+
+#if USE_ADC_OVERSAMPLING
+/**
+ * @brief Read an oversampled value from a specified ADC channel.
+ * 
+ * This function takes 4^n conversions of the channel (n from ADC_OVERSAMPLE_*),
+ * accumulates them and shifts the sum right by n. The result has 12 + n bits.
+ * Only additions and shifts are used, no division.
+ * 
+ * @param channel The ADC channel to read from (AN0, AN1, AN2, AN3, VBGREF, OPA0O, OPA1O, LINEV).
+ * @return The decimated (12 + n)-bit value, or 0 for an invalid channel.
+ */
+unsigned int ReadADCOversampled(unsigned char channel)
+{
+    unsigned long sum = 0;
+    unsigned int count;
+    unsigned char bits;
+
+    if (ADCNeedsSetup(channel))
+    {
+        if (!ADCSetChannel(channel))
+        {
+            return 0; // Invalid channel
+        }
+        ADCSettle(channel, adcSettleSteps[channel]);
+    }
+
+    bits = ADCOversampleBits[channel];
+    count = ADC_OVERSAMPLE_COUNT(bits);
+
+    do
+    {
+        sum += ADCConvert();
+    } while (--count);
+
+    ADCRelease();
+
+    return (unsigned int)(sum >> bits); // Decimate by 2^n
+}
+#endif
@@ -36,6 +36,23 @@
 #define ADC_ON   _adcen = 1; 
 #define ADC_OFF  _adcen = 0; 
 
+// Pulse the START bit to begin a conversion
+#define ADC_START_CONVERSION { _start = 0; _start = 1; _start = 0; }
+
+// Read the conversion result according to the selected data format
+#if ADC_RESOLUTION == RESOLUTION_8BIT
+#define ADC_GET_RESULT()  (((unsigned int)_sadoh << 8) | _sadol)
+#else
+#define ADC_GET_RESULT()  (((unsigned int)_sadoh << 4) | (_sadol >> 4))
+#endif
+
+// Full-scale code of a 12-bit conversion (both data formats); a ratio to VDD is
+// code / ADC_FULL_SCALE. NTC.h and SupplyMonitor.h take it from here.
+#define ADC_FULL_SCALE  4095
+
+// Number of channel numbers (AN0..LINEV), used to size per-channel tables
+#define ADC_NUMBER_OF_CHANNELS  8
+
 // Enable or Disable specific ADC channels
 #define USE_ADC_AN0      Enable
 #define USE_ADC_AN1      Enable
@@ -47,50 +64,202 @@
 #define USE_ADC_LINEV    Enable
 
 
+// SADC0 control bits written together with every channel select:
+// ADCEN (bit 5) keeps the converter on, ADRFS (bit 4) keeps the data format
+#define ADC_SADC0_CONTROL   (0b00100000 | (ADC_RESOLUTION << 4))
+
+// Marks a channel that is disabled in the channel table
+#define ADC_CHANNEL_DISABLED   0x00
+
 // Define ADC channels based on usage
+// ADC_SADC1_x: SADC1 value, ADC_SADC0_x: SADC0 channel select (SACS3~SACS0)
 #if USE_ADC_AN0
 #define AN0 0x00
-#define READ_ADC_SET_AN0 { _sadc1 = 0b00000011; _sadc0 = 0b00000000; }
+#define ADC_SADC1_AN0   0b00000011
+#define ADC_SADC0_AN0   (ADC_SADC0_CONTROL | 0b0000)
+#define READ_ADC_SET_AN0 { _sadc1 = ADC_SADC1_AN0; _sadc0 = ADC_SADC0_AN0; }
+#define ADC_TABLE_AN0   { ADC_SADC0_AN0, ADC_SADC1_AN0 }
+#else
+#define ADC_TABLE_AN0   { ADC_CHANNEL_DISABLED, 0 }
 #endif
 
 #if USE_ADC_AN1
 #define AN1 0x01
-#define READ_ADC_SET_AN1 { _sadc1 = 0b00001000; _sadc0 = 0b00000001; }
+#define ADC_SADC1_AN1   0b00001000
+#define ADC_SADC0_AN1   (ADC_SADC0_CONTROL | 0b0001)
+#define READ_ADC_SET_AN1 { _sadc1 = ADC_SADC1_AN1; _sadc0 = ADC_SADC0_AN1; }
+#define ADC_TABLE_AN1   { ADC_SADC0_AN1, ADC_SADC1_AN1 }
+#else
+#define ADC_TABLE_AN1   { ADC_CHANNEL_DISABLED, 0 }
 #endif
 
 #if USE_ADC_AN2
 #define AN2 0x02
-#define READ_ADC_SET_AN2 { _sadc1 = 0b00000011; _sadc0 = 0b00000010; }
+#define ADC_SADC1_AN2   0b00000011
+#define ADC_SADC0_AN2   (ADC_SADC0_CONTROL | 0b0010)
+#define READ_ADC_SET_AN2 { _sadc1 = ADC_SADC1_AN2; _sadc0 = ADC_SADC0_AN2; }
+#define ADC_TABLE_AN2   { ADC_SADC0_AN2, ADC_SADC1_AN2 }
+#else
+#define ADC_TABLE_AN2   { ADC_CHANNEL_DISABLED, 0 }
 #endif
 
 #if USE_ADC_AN3
 #define AN3 0x03
-#define READ_ADC_SET_AN3 { _sadc1 = 0b00000011; _sadc0 = 0b00000011; }
+#define ADC_SADC1_AN3   0b00000011
+#define ADC_SADC0_AN3   (ADC_SADC0_CONTROL | 0b0011)
+#define READ_ADC_SET_AN3 { _sadc1 = ADC_SADC1_AN3; _sadc0 = ADC_SADC0_AN3; }
+#define ADC_TABLE_AN3   { ADC_SADC0_AN3, ADC_SADC1_AN3 }
+#else
+#define ADC_TABLE_AN3   { ADC_CHANNEL_DISABLED, 0 }
 #endif
 
 #if USE_ADC_VBGREF
 #define VBGREF 0x04
-#define READ_ADC_SET_VBGREF { _sadc1 = 0b00101011; _sadc0 = 0b00010111; }
+#define ADC_SADC1_VBGREF   0b00101011
+#define ADC_SADC0_VBGREF   (ADC_SADC0_CONTROL | 0b0111)
+#define READ_ADC_SET_VBGREF { _sadc1 = ADC_SADC1_VBGREF; _sadc0 = ADC_SADC0_VBGREF; }
+#define ADC_TABLE_VBGREF   { ADC_SADC0_VBGREF, ADC_SADC1_VBGREF }
+#else
+#define ADC_TABLE_VBGREF   { ADC_CHANNEL_DISABLED, 0 }
 #endif
 
 #if USE_ADC_OPA0O
 #define OPA0O 0x05
-#define READ_ADC_SET_OPA0O { _sadc1 = 0b01000011; _sadc0 = 0b00000111; }
+#define ADC_SADC1_OPA0O   0b01000011
+#define ADC_SADC0_OPA0O   (ADC_SADC0_CONTROL | 0b0111)
+#define READ_ADC_SET_OPA0O { _sadc1 = ADC_SADC1_OPA0O; _sadc0 = ADC_SADC0_OPA0O; }
+#define ADC_TABLE_OPA0O   { ADC_SADC0_OPA0O, ADC_SADC1_OPA0O }
+#else
+#define ADC_TABLE_OPA0O   { ADC_CHANNEL_DISABLED, 0 }
 #endif
 
 #if USE_ADC_OPA1O
 #define OPA1O 0x06
-#define READ_ADC_SET_OPA1O { _sadc1 = 0b01101011; _sadc0 = 0b00000111; }
+#define ADC_SADC1_OPA1O   0b01101011
+#define ADC_SADC0_OPA1O   (ADC_SADC0_CONTROL | 0b0111)
+#define READ_ADC_SET_OPA1O { _sadc1 = ADC_SADC1_OPA1O; _sadc0 = ADC_SADC0_OPA1O; }
+#define ADC_TABLE_OPA1O   { ADC_SADC0_OPA1O, ADC_SADC1_OPA1O }
+#else
+#define ADC_TABLE_OPA1O   { ADC_CHANNEL_DISABLED, 0 }
 #endif
 
 #if USE_ADC_LINEV
 #define LINEV 0x07
-#define READ_ADC_SET_LINEV { _sadc1 = 0b10000011; _sadc0 = 0b00000111; }
+#define ADC_SADC1_LINEV   0b10000011
+#define ADC_SADC0_LINEV   (ADC_SADC0_CONTROL | 0b0111)
+#define READ_ADC_SET_LINEV { _sadc1 = ADC_SADC1_LINEV; _sadc0 = ADC_SADC0_LINEV; }
+#define ADC_TABLE_LINEV   { ADC_SADC0_LINEV, ADC_SADC1_LINEV }
+#else
+#define ADC_TABLE_LINEV   { ADC_CHANNEL_DISABLED, 0 }
+#endif
+
+// Every channel setup rewrites ADRFS with SADC0, so each one has to carry the
+// data format that ADC_GET_RESULT() decodes
+#define ADC_SADC0_ADRFS(sadc0)  (((sadc0) >> 4) & 1)
+#if (USE_ADC_AN0 && ADC_SADC0_ADRFS(ADC_SADC0_AN0) != ADC_RESOLUTION) || \
+    (USE_ADC_AN1 && ADC_SADC0_ADRFS(ADC_SADC0_AN1) != ADC_RESOLUTION) || \
+    (USE_ADC_AN2 && ADC_SADC0_ADRFS(ADC_SADC0_AN2) != ADC_RESOLUTION) || \
+    (USE_ADC_AN3 && ADC_SADC0_ADRFS(ADC_SADC0_AN3) != ADC_RESOLUTION) || \
+    (USE_ADC_VBGREF && ADC_SADC0_ADRFS(ADC_SADC0_VBGREF) != ADC_RESOLUTION) || \
+    (USE_ADC_OPA0O && ADC_SADC0_ADRFS(ADC_SADC0_OPA0O) != ADC_RESOLUTION) || \
+    (USE_ADC_OPA1O && ADC_SADC0_ADRFS(ADC_SADC0_OPA1O) != ADC_RESOLUTION) || \
+    (USE_ADC_LINEV && ADC_SADC0_ADRFS(ADC_SADC0_LINEV) != ADC_RESOLUTION)
+#error "A channel's SADC0 setup does not match the ADC_RESOLUTION data format"
+#endif
+
+// Oversampling and decimation
+// 4^n conversions are accumulated and shifted right by n, which gives a
+// (12 + n)-bit result. n = 0 takes a single conversion, n = 4 gives 16 bits.
+#define USE_ADC_OVERSAMPLING     Enable
+
+#define ADC_OVERSAMPLE_AN0       0
+#define ADC_OVERSAMPLE_AN1       0
+#define ADC_OVERSAMPLE_AN2       0
+#define ADC_OVERSAMPLE_AN3       0
+#define ADC_OVERSAMPLE_VBGREF    0
+#define ADC_OVERSAMPLE_OPA0O     0
+#define ADC_OVERSAMPLE_OPA1O     4
+#define ADC_OVERSAMPLE_LINEV     0
+
+#if (ADC_OVERSAMPLE_AN0 > 4) || (ADC_OVERSAMPLE_AN1 > 4) || (ADC_OVERSAMPLE_AN2 > 4) || \
+    (ADC_OVERSAMPLE_AN3 > 4) || (ADC_OVERSAMPLE_VBGREF > 4) || (ADC_OVERSAMPLE_OPA0O > 4) || \
+    (ADC_OVERSAMPLE_OPA1O > 4) || (ADC_OVERSAMPLE_LINEV > 4)
+#error "ADC oversampling n must be 0..4 (results are limited to 16 bits)"
 #endif
 
+// Number of conversions taken for an oversampling setting n (4^n)
+#define ADC_OVERSAMPLE_COUNT(n)  ((unsigned int)1 << ((n) << 1))
+
+// Continuous-power (burst) mode
+// Between ADCBurstBegin() and ADCBurstEnd() the ADC stays powered and a
+// channel's settling delay is only paid when the multiplexer changes channel.
+#define USE_ADC_BURST_MODE       Enable
+
+// Settling delay after switching to a channel, in instruction cycles
+#define ADC_SETTLE_CYCLES_AN0      12
+#define ADC_SETTLE_CYCLES_AN1      12
+#define ADC_SETTLE_CYCLES_AN2      12
+#define ADC_SETTLE_CYCLES_AN3      12
+#define ADC_SETTLE_CYCLES_VBGREF   4
+#define ADC_SETTLE_CYCLES_OPA0O    48
+#define ADC_SETTLE_CYCLES_OPA1O    48
+#define ADC_SETTLE_CYCLES_LINEV    24
+
+// The settling delay runs in steps of GCC_DELAY(ADC_SETTLE_STEP_CYCLES)
+#define ADC_SETTLE_STEP_CYCLES     4
+#define ADC_SETTLE_STEPS(cycles)   (((cycles) + ADC_SETTLE_STEP_CYCLES - 1) / ADC_SETTLE_STEP_CYCLES)
+
+// Marks that no channel is routed to the ADC yet
+#define ADC_NO_CHANNEL             0xFF
+
 
 // Function prototypes
 void ADCInit();
+unsigned char ADCSetChannel(unsigned char channel);
+void ADCSettleChannel(unsigned char channel);
 unsigned int ReadADC(unsigned char channel);
+unsigned int ADCConversionCycles(unsigned char channel);
+
+// Interrupt-driven users (scan sequencer, timer trigger): one at a time, and
+// ReadADC() must not be used while one of them owns the ADC
+unsigned char ADCInterruptClaim(void);
+void ADCInterruptRelease(void);
+unsigned char ADCInterruptBusy(void);
+
+// Fixed-channel reads, the channel setup is folded into immediate writes
+#if USE_ADC_AN0
+unsigned int ReadADC_AN0(void);
+#endif
+#if USE_ADC_AN1
+unsigned int ReadADC_AN1(void);
+#endif
+#if USE_ADC_AN2
+unsigned int ReadADC_AN2(void);
+#endif
+#if USE_ADC_AN3
+unsigned int ReadADC_AN3(void);
+#endif
+#if USE_ADC_VBGREF
+unsigned int ReadADC_VBGREF(void);
+#endif
+#if USE_ADC_OPA0O
+unsigned int ReadADC_OPA0O(void);
+#endif
+#if USE_ADC_OPA1O
+unsigned int ReadADC_OPA1O(void);
+#endif
+#if USE_ADC_LINEV
+unsigned int ReadADC_LINEV(void);
+#endif
+
+#if USE_ADC_BURST_MODE
+void ADCBurstBegin(void);
+void ADCBurstEnd(void);
+#endif
+
+#if USE_ADC_OVERSAMPLING
+extern const unsigned char ADCOversampleBits[ADC_NUMBER_OF_CHANNELS]; // Oversampling n, indexed by channel
+unsigned int ReadADCOversampled(unsigned char channel);
+#endif
 
 #endif // ADC_H_
@@ -0,0 +1,348 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file ADCScan.c
+ * @brief Implementation of the interrupt-driven ADC scan sequencer.
+ *
+ * The ADC interrupt stores each finished conversion and immediately starts
+ * the next channel of the list, so the CPU never polls _adbz. The ring buffer
+ * is single-producer (ISR writes the head) and single-consumer (main code
+ * writes the tail), so neither side has to disable interrupts to move its index.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "ADCScan.h"
+
+#if USE_ADC_SCAN_SEQUENCER
+
+// Channel list walked by the sequencer
+static const unsigned char adcScanChannels[ADC_SCAN_NUMBER_OF_CHANNELS] = ADC_SCAN_CHANNELS;
+
+// Latest finished result of every channel
+static volatile unsigned int adcScanLatest[ADC_NUMBER_OF_CHANNELS];
+
+// Sample ring buffer and its indexes
+static volatile ADCSample adcScanBuffer[ADC_SCAN_BUFFER_SIZE];
+static volatile unsigned char adcScanHead; // Written by the ISR only
+static volatile unsigned char adcScanTail; // Written by main code only
+
+static volatile unsigned char adcScanIndex;   // Position in adcScanChannels
+static volatile unsigned char adcScanRunning;
+
+#if USE_ADC_OVERSAMPLING
+static volatile unsigned long adcScanAccumulator; // Sum of the current channel's conversions
+static volatile unsigned int adcScanRemaining;    // Conversions left for the current channel
+#endif
+
+#if USE_ADC_WINDOW_COMPARATOR
+// Window of every channel, indexed by channel number
+static const ADCWindow adcWindows[ADC_NUMBER_OF_CHANNELS] = {
+    ADC_WINDOW_AN0, ADC_WINDOW_AN1, ADC_WINDOW_AN2, ADC_WINDOW_AN3,
+    ADC_WINDOW_VBGREF, ADC_WINDOW_OPA0O, ADC_WINDOW_OPA1O, ADC_WINDOW_LINEV
+};
+
+static volatile unsigned char adcWindowOutside; // Channels outside their window
+static volatile unsigned char adcWindowEvents;  // Crossings not yet taken by main code
+#endif
+
+volatile unsigned char ADCScanCycleCount;
+volatile unsigned char ADCScanOverrunCount;
+
+/**
+ * @brief Initialize the scan sequencer.
+ *
+ * Clears the result tables and enables the ADC interrupt (_ade).
+ */
+void ADCScanInit(void)
+{
+    unsigned char i;
+
+    adcScanRunning = 0;
+    adcScanIndex = 0;
+    adcScanHead = 0;
+    adcScanTail = 0;
+    ADCScanCycleCount = 0;
+    ADCScanOverrunCount = 0;
+
+    for (i = 0; i < ADC_NUMBER_OF_CHANNELS; i++)
+    {
+        adcScanLatest[i] = 0;
+    }
+
+#if USE_ADC_WINDOW_COMPARATOR
+    adcWindowOutside = 0; // Every channel starts inside its window
+    adcWindowEvents = 0;
+#endif
+
+    _adf = 0; // Clear any pending end-of-conversion flag
+    _ade = 1; // Enable analog interrupt
+}
+
+/**
+ * @brief Start scanning from the first channel of the list.
+ *
+ * @return 1 if the scan was started, 0 if the timer trigger owns the ADC.
+ */
+unsigned char ADCScanStart(void)
+{
+    if (!adcScanRunning && !ADCInterruptClaim())
+    {
+        return 0; // The timer trigger is using the ADC
+    }
+
+    adcScanIndex = 0;
+    adcScanRunning = 1;
+
+#if USE_ADC_OVERSAMPLING
+    adcScanAccumulator = 0;
+    adcScanRemaining = ADC_OVERSAMPLE_COUNT(ADCOversampleBits[adcScanChannels[0]]);
+#endif
+
+    ADCSetChannel(adcScanChannels[0]);
+    ADC_ON;
+    GCC_DELAY(12); // Let the converter power up before the first conversion
+    ADCSettleChannel(adcScanChannels[0]);
+    ADC_START_CONVERSION;
+    return 1;
+}
+
+/**
+ * @brief Stop scanning and power the ADC off.
+ *
+ * The conversion in progress (if any) is discarded by ADCScanISR().
+ */
+void ADCScanStop(void)
+{
+    if (adcScanRunning)
+    {
+        ADCInterruptRelease();
+    }
+    adcScanRunning = 0;
+    ADC_OFF;
+}
+
+/**
+ * @brief Check whether the sequencer is running.
+ *
+ * @return 1 while a scan is in progress, 0 otherwise.
+ */
+unsigned char ADCScanIsRunning(void)
+{
+    return adcScanRunning;
+}
+
+/**
+ * @brief Read the latest finished result of a channel.
+ *
+ * The ADC interrupt is masked for the two byte reads so the value cannot
+ * be torn by a conversion that finishes in between, then put back as the
+ * caller had it.
+ *
+ * @param channel The ADC channel to read.
+ * @return The latest conversion result, or 0 for an invalid channel.
+ */
+unsigned int ADCScanRead(unsigned char channel)
+{
+    unsigned int value;
+    unsigned char ade;
+
+    if (channel >= ADC_NUMBER_OF_CHANNELS)
+    {
+        return 0; // Invalid channel
+    }
+
+    ade = _ade;
+    _ade = 0;
+    value = adcScanLatest[channel];
+    _ade = ade;
+
+    return value;
+}
+
+/**
+ * @brief Get the number of samples waiting in the ring buffer.
+ *
+ * @return The number of unread samples.
+ */
+unsigned char ADCScanAvailable(void)
+{
+    return (adcScanHead - adcScanTail) & (ADC_SCAN_BUFFER_SIZE - 1);
+}
+
+/**
+ * @brief Take the oldest sample out of the ring buffer.
+ *
+ * @param sample Pointer to the sample to fill.
+ * @return 1 if a sample was taken, 0 if the ring buffer is empty.
+ */
+unsigned char ADCScanGetSample(ADCSample *sample)
+{
+    unsigned char tail = adcScanTail;
+
+    if (tail == adcScanHead)
+    {
+        return 0; // Ring buffer is empty
+    }
+
+    sample->channel = adcScanBuffer[tail].channel;
+    sample->value = adcScanBuffer[tail].value;
+
+    // Publish the free slot only after the sample has been copied out
+    adcScanTail = (tail + 1) & (ADC_SCAN_BUFFER_SIZE - 1);
+    return 1;
+}
+
+#if USE_ADC_WINDOW_COMPARATOR
+/**
+ * @brief Compare a result against its channel's window.
+ *
+ * Raises the channel's event bit when it leaves or re-enters the window.
+ *
+ * @param channel The channel the result belongs to.
+ * @param value The stored result.
+ */
+static void ADCWindowCheck(unsigned char channel, unsigned int value)
+{
+    const ADCWindow *window = &adcWindows[channel];
+    unsigned char mask = (unsigned char)(1 << channel);
+
+    if (adcWindowOutside & mask)
+    {
+        // Re-enter only with the hysteresis margin on both sides
+        if ((value >= window->low + window->hysteresis) && (value <= window->high - window->hysteresis))
+        {
+            adcWindowOutside &= (unsigned char)~mask;
+            adcWindowEvents |= mask;
+        }
+    }
+    else if ((value < window->low) || (value > window->high))
+    {
+        adcWindowOutside |= mask;
+        adcWindowEvents |= mask;
+    }
+}
+
+/**
+ * @brief Check whether a window event is waiting.
+ *
+ * @return Non-zero if ADCWindowGetEvents() has events to return.
+ */
+unsigned char ADCWindowPending(void)
+{
+    return adcWindowEvents;
+}
+
+/**
+ * @brief Take the channels that crossed their window since the last call.
+ *
+ * @return Bit mask of channels that entered or left their window.
+ */
+unsigned char ADCWindowGetEvents(void)
+{
+    unsigned char events;
+    unsigned char ade = _ade;
+
+    _ade = 0; // Read and clear without losing an event raised in between
+    events = adcWindowEvents;
+    adcWindowEvents = 0;
+    _ade = ade;
+
+    return events;
+}
+
+/**
+ * @brief Get the channels that are currently outside their window.
+ *
+ * @return Bit mask of channels outside their window.
+ */
+unsigned char ADCWindowGetOutside(void)
+{
+    return adcWindowOutside;
+}
+#endif
+
+/**
+ * @brief ADC end-of-conversion handler.
+ *
+ * Stores the result of the channel that just finished, then selects the
+ * next channel of the list, waits for its settling delay and starts its
+ * conversion. With oversampling the sequencer stays on a channel until its
+ * 4^n conversions are accumulated, and only the first one pays the delay.
+ */
+void ADCScanISR(void)
+{
+    unsigned char channel;
+    unsigned char head;
+    unsigned char next;
+    unsigned int value;
+
+    if (!adcScanRunning)
+    {
+        return; // Conversion was not started by the sequencer
+    }
+
+    channel = adcScanChannels[adcScanIndex];
+
+#if USE_ADC_OVERSAMPLING
+    adcScanAccumulator += ADC_GET_RESULT();
+    if (--adcScanRemaining)
+    {
+        ADC_START_CONVERSION; // More conversions of the same channel
+        return;
+    }
+    value = (unsigned int)(adcScanAccumulator >> ADCOversampleBits[channel]);
+    adcScanAccumulator = 0;
+#else
+    value = ADC_GET_RESULT();
+#endif
+
+    adcScanLatest[channel] = value;
+
+#if USE_ADC_WINDOW_COMPARATOR
+    ADCWindowCheck(channel, value);
+#endif
+
+    // Push into the ring buffer, drop the sample if it is full
+    head = adcScanHead;
+    next = (head + 1) & (ADC_SCAN_BUFFER_SIZE - 1);
+    if (next != adcScanTail)
+    {
+        adcScanBuffer[head].channel = channel;
+        adcScanBuffer[head].value = value;
+        adcScanHead = next;
+    }
+    else
+    {
+        ADCScanOverrunCount++;
+    }
+
+    // Advance to the next channel of the list
+    if (++adcScanIndex >= ADC_SCAN_NUMBER_OF_CHANNELS)
+    {
+        adcScanIndex = 0;
+        ADCScanCycleCount++;
+
+    #if ADC_SCAN_MODE == ADC_SCAN_SINGLE
+        adcScanRunning = 0;
+        ADC_OFF;
+        return;
+    #endif
+    }
+
+    channel = adcScanChannels[adcScanIndex];
+#if USE_ADC_OVERSAMPLING
+    adcScanRemaining = ADC_OVERSAMPLE_COUNT(ADCOversampleBits[channel]);
+#endif
+    ADCSetChannel(channel);
+    ADCSettleChannel(channel); // The new input must settle before it is sampled
+    ADC_START_CONVERSION;
+}
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file ADCScan.h
+ * @brief Header file for the interrupt-driven ADC scan sequencer.
+ *
+ * The sequencer walks a configured list of ADC channels from the ADC
+ * end-of-conversion interrupt. Every result is written into a per-channel
+ * latest-value table and into a small sample ring buffer, so main code only
+ * reads finished results and never waits on _adbz. Channels with an
+ * ADC_OVERSAMPLE_* setting are stored as decimated (12 + n)-bit values.
+ *
+ * All register access goes through the ADC.h macros (ADC_ON, ADC_START_CONVERSION,
+ * ADC_GET_RESULT, READ_ADC_SET_*), so the sequencer also builds on a host:
+ * tools/ADCScanHost compiles it against a simulated register file and drives
+ * it by calling ADCScanISR() (`make test`).
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef ADC_SCAN_H_
+#define ADC_SCAN_H_
+
+#include "ADC.h"
+
+// Enable or Disable the scan sequencer
+#define USE_ADC_SCAN_SEQUENCER   Enable
+
+// Channels walked by the sequencer, in order (only channels enabled by USE_ADC_*)
+#define ADC_SCAN_CHANNELS            { AN0, AN1, VBGREF, OPA1O, LINEV }
+#define ADC_SCAN_NUMBER_OF_CHANNELS  5
+
+// Sample ring buffer length, must be a power of two
+#define ADC_SCAN_BUFFER_SIZE     8
+
+// Scan modes
+#define ADC_SCAN_SINGLE          0 /**< Stop after one pass over the channel list */
+#define ADC_SCAN_CONTINUOUS      1 /**< Restart at the first channel after the last one */
+#define ADC_SCAN_MODE            ADC_SCAN_CONTINUOUS
+
+#if (ADC_SCAN_BUFFER_SIZE & (ADC_SCAN_BUFFER_SIZE - 1)) != 0
+#error "ADC_SCAN_BUFFER_SIZE must be a power of two"
+#endif
+
+// Window comparator
+// Every stored result is compared against its channel's window. A channel
+// leaves the window below low or above high, and only comes back once it is
+// at least hysteresis codes inside both limits. An event bit is raised on
+// every crossing, so main code can stay in Enter_Idle1_Mode() until one
+// arrives. Limits are in the units stored by the sequencer ((12 + n)-bit
+// with oversampling).
+#define USE_ADC_WINDOW_COMPARATOR  Enable
+
+// ADC_WINDOW(low, high, hysteresis), or ADC_WINDOW_NONE for no events
+#define ADC_WINDOW(low, high, hysteresis)  { (low), (high), (hysteresis) }
+#define ADC_WINDOW_NONE                    ADC_WINDOW(0, 0xFFFF, 0)
+
+#define ADC_WINDOW_AN0       ADC_WINDOW(500, 3500, 40)
+#define ADC_WINDOW_AN1       ADC_WINDOW_NONE
+#define ADC_WINDOW_AN2       ADC_WINDOW_NONE
+#define ADC_WINDOW_AN3       ADC_WINDOW_NONE
+#define ADC_WINDOW_VBGREF    ADC_WINDOW_NONE
+#define ADC_WINDOW_OPA0O     ADC_WINDOW_NONE
+#define ADC_WINDOW_OPA1O     ADC_WINDOW_NONE
+#define ADC_WINDOW_LINEV     ADC_WINDOW_NONE
+
+/** @brief Window limits of one channel. */
+typedef struct
+{
+    unsigned int low;        /**< Lowest value inside the window */
+    unsigned int high;       /**< Highest value inside the window */
+    unsigned int hysteresis; /**< Margin needed to re-enter the window */
+} ADCWindow;
+
+/** @brief One entry of the sample ring buffer. */
+typedef struct
+{
+    unsigned char channel; /**< Channel the sample was taken from */
+    unsigned int  value;   /**< Conversion result */
+} ADCSample;
+
+#if USE_ADC_SCAN_SEQUENCER
+
+/** @brief Number of completed passes over the channel list (wraps at 255). */
+extern volatile unsigned char ADCScanCycleCount;
+
+/** @brief Number of samples dropped because the ring buffer was full. */
+extern volatile unsigned char ADCScanOverrunCount;
+
+/**
+ * @brief Initialize the scan sequencer.
+ *
+ * Clears the result tables and enables the ADC interrupt (_ade).
+ * ADCInit() must be called first.
+ */
+void ADCScanInit(void);
+
+/**
+ * @brief Start scanning from the first channel of ADC_SCAN_CHANNELS.
+ *
+ * Powers the ADC on and starts the first conversion; the rest of the pass
+ * runs from ADCScanISR(). ReadADC() must not be used while a scan is running.
+ *
+ * @return 1 if the scan was started, 0 if the timer trigger owns the ADC.
+ */
+unsigned char ADCScanStart(void);
+
+/**
+ * @brief Stop scanning after the conversion in progress and power the ADC off.
+ */
+void ADCScanStop(void);
+
+/**
+ * @brief Check whether the sequencer is running.
+ *
+ * @return 1 while a scan is in progress, 0 otherwise.
+ */
+unsigned char ADCScanIsRunning(void);
+
+/**
+ * @brief Read the latest finished result of a channel.
+ *
+ * @param channel The ADC channel (AN0, AN1, AN2, AN3, VBGREF, OPA0O, OPA1O, LINEV).
+ * @return The latest conversion result, or 0 if the channel has not been sampled.
+ */
+unsigned int ADCScanRead(unsigned char channel);
+
+/**
+ * @brief Get the number of samples waiting in the ring buffer.
+ *
+ * @return The number of unread samples.
+ */
+unsigned char ADCScanAvailable(void);
+
+/**
+ * @brief Take the oldest sample out of the ring buffer.
+ *
+ * @param sample Pointer to the sample to fill.
+ * @return 1 if a sample was taken, 0 if the ring buffer is empty.
+ */
+unsigned char ADCScanGetSample(ADCSample *sample);
+
+#if USE_ADC_WINDOW_COMPARATOR
+
+/**
+ * @brief Check whether a window event is waiting.
+ *
+ * Cheap enough for an idle loop:
+ * @code
+ * while (!ADCWindowPending()) Enter_Idle1_Mode();
+ * events = ADCWindowGetEvents();
+ * @endcode
+ * The ADC clock is derived from fSYS, so the scan keeps running in IDLE1 but
+ * stops in IDLE0 (only useful when another wake-up source is in use). An event
+ * raised between the check and HALT is seen after the next conversion.
+ *
+ * @return Non-zero if ADCWindowGetEvents() has events to return.
+ */
+unsigned char ADCWindowPending(void);
+
+/**
+ * @brief Take the channels that crossed their window since the last call.
+ *
+ * @return Bit mask of channels (bit n = channel n) that entered or left their window.
+ */
+unsigned char ADCWindowGetEvents(void);
+
+/**
+ * @brief Get the channels that are currently outside their window.
+ *
+ * @return Bit mask of channels (bit n = channel n) outside their window.
+ */
+unsigned char ADCWindowGetOutside(void);
+
+#endif
+
+/**
+ * @brief ADC end-of-conversion handler.
+ *
+ * Stores the finished result, selects the next channel and starts its
+ * conversion. Called from the ADC interrupt vector (ADC_ISR_ADDRESS).
+ */
+void ADCScanISR(void);
+
+#endif
+
+#endif // ADC_SCAN_H_
@@ -0,0 +1,214 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file ADCTrigger.c
+ * @brief Implementation of timer-triggered ADC sampling.
+ *
+ * The timer interrupt only pulses START, so the sample instant follows the
+ * timer period with the interrupt entry latency as the only jitter. The ADC
+ * interrupt then pushes the result and its tick into an SPSC ring buffer.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "ADCTrigger.h"
+
+#if ADC_TRIGGER_FEED_LINE_MONITOR
+#include "LineMonitor.h"
+#endif
+
+#if USE_ADC_TIMER_TRIGGER
+
+// Sample ring buffer and its indexes
+static volatile ADCTimedSample adcTriggerBuffer[ADC_TRIGGER_BUFFER_SIZE];
+static volatile unsigned char adcTriggerHead; // Written by the ADC ISR only
+static volatile unsigned char adcTriggerTail; // Written by main code only
+
+static volatile unsigned int adcTriggerTick;      // Trigger periods since start
+static volatile unsigned int adcTriggerStartTick; // Tick of the conversion in progress
+static volatile unsigned char adcTriggerRunning;
+
+volatile unsigned char ADCTriggerMissedCount;
+volatile unsigned char ADCTriggerOverrunCount;
+
+/**
+ * @brief Initialize timer-triggered sampling.
+ */
+void ADCTriggerInit(void)
+{
+    adcTriggerRunning = 0;
+    adcTriggerHead = 0;
+    adcTriggerTail = 0;
+    ADCTriggerMissedCount = 0;
+    ADCTriggerOverrunCount = 0;
+
+#if ADC_TRIGGER_SOURCE == ADC_TRIGGER_STM
+    // STM is cleared on comparator A match, so CCRA sets the sample period
+    _stmal = ADC_TRIGGER_COMPARE & 0xFF;
+    _stmah = (ADC_TRIGGER_COMPARE >> 8) & 3;
+#else
+    // PTM is cleared on comparator P match, so CCRP sets the sample period
+    _ptmrpl = ADC_TRIGGER_COMPARE & 0xFF;
+    _ptmrph = (ADC_TRIGGER_COMPARE >> 8) & 3;
+#endif
+
+    _adf = 0; // Clear any pending end-of-conversion flag
+    _ade = 1; // Enable analog interrupt
+}
+
+/**
+ * @brief Reset the tick count and start triggering conversions.
+ *
+ * The ADC stays powered while triggering, so every trigger can start a
+ * conversion at once.
+ *
+ * @return 1 if triggering was started, 0 if the scan sequencer owns the ADC.
+ */
+unsigned char ADCTriggerStart(void)
+{
+    if (!adcTriggerRunning && !ADCInterruptClaim())
+    {
+        return 0; // The scan sequencer is using the ADC
+    }
+
+    // Route the channel and power the converter (ADCEN is part of the setup)
+    ADCSetChannel(ADC_TRIGGER_CHANNEL);
+    GCC_DELAY(12); // Let the converter and the input settle
+
+    adcTriggerTick = 0;
+    adcTriggerRunning = 1;
+
+#if ADC_TRIGGER_SOURCE == ADC_TRIGGER_STM
+    _ston = 0;   // Restart the counter from zero
+    _stmaf = 0;
+    _stmae = 1;
+    _ston = 1;
+#else
+    _pton = 0;   // Restart the counter from zero
+    _ptmpf = 0;
+    _ptmpe = 1;
+    _pton = 1;
+#endif
+    return 1;
+}
+
+/**
+ * @brief Stop triggering conversions and power the ADC off.
+ *
+ * A conversion in progress is discarded.
+ */
+void ADCTriggerStop(void)
+{
+#if ADC_TRIGGER_SOURCE == ADC_TRIGGER_STM
+    _stmae = 0;
+#else
+    _ptmpe = 0;
+#endif
+    if (adcTriggerRunning)
+    {
+        ADCInterruptRelease();
+    }
+    adcTriggerRunning = 0;
+    ADC_OFF;
+}
+
+/**
+ * @brief Get the number of samples waiting in the ring buffer.
+ *
+ * @return The number of unread samples.
+ */
+unsigned char ADCTriggerAvailable(void)
+{
+    return (adcTriggerHead - adcTriggerTail) & (ADC_TRIGGER_BUFFER_SIZE - 1);
+}
+
+/**
+ * @brief Take the oldest sample out of the ring buffer.
+ *
+ * @param sample Pointer to the sample to fill.
+ * @return 1 if a sample was taken, 0 if the ring buffer is empty.
+ */
+unsigned char ADCTriggerGetSample(ADCTimedSample *sample)
+{
+    unsigned char tail = adcTriggerTail;
+
+    if (tail == adcTriggerHead)
+    {
+        return 0; // Ring buffer is empty
+    }
+
+    sample->tick = adcTriggerBuffer[tail].tick;
+    sample->value = adcTriggerBuffer[tail].value;
+
+    // Publish the free slot only after the sample has been copied out
+    adcTriggerTail = (tail + 1) & (ADC_TRIGGER_BUFFER_SIZE - 1);
+    return 1;
+}
+
+/**
+ * @brief Trigger timer handler, starts the next conversion.
+ *
+ * START is pulsed first so the sample instant does not depend on the
+ * bookkeeping below.
+ */
+void ADCTriggerTimerISR(void)
+{
+    if (!adcTriggerRunning)
+    {
+        return;
+    }
+
+    if (_adbz)
+    {
+        ADCTriggerMissedCount++; // Previous conversion still running
+        adcTriggerTick++;
+        return;
+    }
+
+    ADC_START_CONVERSION;
+    adcTriggerStartTick = adcTriggerTick++;
+}
+
+/**
+ * @brief ADC end-of-conversion handler, stores the sample with its tick.
+ *
+ * With ADC_TRIGGER_FEED_LINE_MONITOR the sample is also added to the line
+ * monitor window here, whether or not the ring buffer has room for it.
+ */
+void ADCTriggerADCISR(void)
+{
+    unsigned char head;
+    unsigned char next;
+    unsigned int value;
+
+    if (!adcTriggerRunning)
+    {
+        return; // Conversion was not started by the trigger
+    }
+
+    value = ADC_GET_RESULT();
+
+#if ADC_TRIGGER_FEED_LINE_MONITOR && USE_LINE_MONITOR
+    LineMonitorAddSample(value);
+#endif
+
+    head = adcTriggerHead;
+    next = (head + 1) & (ADC_TRIGGER_BUFFER_SIZE - 1);
+    if (next == adcTriggerTail)
+    {
+        ADCTriggerOverrunCount++; // Ring buffer is full, drop the sample
+        return;
+    }
+
+    adcTriggerBuffer[head].tick = adcTriggerStartTick;
+    adcTriggerBuffer[head].value = value;
+    adcTriggerHead = next;
+}
+
+#endif
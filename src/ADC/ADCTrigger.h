@@ -0,0 +1,160 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file ADCTrigger.h
+ * @brief Header file for timer-triggered ADC sampling.
+ *
+ * A timer compare match starts every conversion of one channel, so the
+ * sample period comes from the timer hardware instead of a polling loop.
+ * The trigger is either the STM comparator A match (STM_COMPAIR_A_ISR, with
+ * the STM cleared on CCRA match) or the PTM period match (PTM_COMPAIR_P_ISR,
+ * with the PTM cleared on CCRP match). Every sample is stored together with
+ * its tick, the number of trigger periods since ADCTriggerStart().
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef ADC_TRIGGER_H_
+#define ADC_TRIGGER_H_
+
+#include "ADC.h"
+
+// Enable or Disable timer-triggered sampling
+#define USE_ADC_TIMER_TRIGGER    Enable
+
+// Trigger sources
+#define ADC_TRIGGER_STM          0 /**< STM comparator A match */
+#define ADC_TRIGGER_PTM          1 /**< PTM comparator P (period) match */
+#define ADC_TRIGGER_SOURCE       ADC_TRIGGER_STM
+
+// Sampled channel and sample rate in Hz
+#define ADC_TRIGGER_CHANNEL      LINEV
+#define ADC_TRIGGER_RATE_HZ      8000UL
+
+// Sample ring buffer length, must be a power of two
+#define ADC_TRIGGER_BUFFER_SIZE  8
+
+// Feed every sample to LineMonitorAddSample() from the ADC interrupt
+#define ADC_TRIGGER_FEED_LINE_MONITOR  Enable
+
+#if ADC_TRIGGER_SOURCE == ADC_TRIGGER_STM
+    #include "STM.h"
+    #if STM_SELECT_CLEAR_COMPARE_MATCH != STM_COMPARE_MATCH_A
+    #error "STM trigger needs STM_SELECT_CLEAR_COMPARE_MATCH = STM_COMPARE_MATCH_A"
+    #endif
+    #if (STM_MODE != STM_COMPARE_MATCH_OUTPUT_MODE) && (STM_MODE != STM_TIMER_COUNTER_MODE)
+    #error "STM trigger needs STM_MODE in compare match output or timer/counter mode"
+    #endif
+    #ifdef STM_CLOCK_HZ
+    #define ADC_TRIGGER_CLOCK_HZ   STM_CLOCK_HZ
+    #endif
+#else
+    #include "PTM.h"
+    #if PTM_SELECT_CLEAR_COMPARE_MATCH != PTM_COMPARE_MATCH_P
+    #error "PTM trigger needs PTM_SELECT_CLEAR_COMPARE_MATCH = PTM_COMPARE_MATCH_P"
+    #endif
+    #if (PTM_MODE != PTM_COMPARE_MATCH_OUTPUT_MODE) && (PTM_MODE != PTM_TIMER_COUNTER_MODE)
+    #error "PTM trigger needs PTM_MODE in compare match output or timer/counter mode"
+    #endif
+    #ifdef PTM_CLOCK_HZ
+    #define ADC_TRIGGER_CLOCK_HZ   PTM_CLOCK_HZ
+    #endif
+#endif
+
+#ifndef ADC_TRIGGER_CLOCK_HZ
+#error "The trigger timer must run from an internal clock with a known frequency"
+#endif
+
+// Timer counts per sample, rounded to the nearest count
+#define ADC_TRIGGER_PERIOD       ((ADC_TRIGGER_CLOCK_HZ + ADC_TRIGGER_RATE_HZ / 2) / ADC_TRIGGER_RATE_HZ)
+
+#if (ADC_TRIGGER_PERIOD < 2) || (ADC_TRIGGER_PERIOD > 1024)
+#error "ADC_TRIGGER_RATE_HZ cannot be reached with the selected timer clock (period must be 2..1024 counts)"
+#endif
+
+// 10-bit compare value, a period of 1024 counts is written as 0
+#define ADC_TRIGGER_COMPARE      (ADC_TRIGGER_PERIOD & 0x3FF)
+
+// Sample rate actually produced by the timer, in Hz
+#define ADC_TRIGGER_ACTUAL_RATE_HZ  (ADC_TRIGGER_CLOCK_HZ / ADC_TRIGGER_PERIOD)
+
+#if (ADC_TRIGGER_BUFFER_SIZE & (ADC_TRIGGER_BUFFER_SIZE - 1)) != 0
+#error "ADC_TRIGGER_BUFFER_SIZE must be a power of two"
+#endif
+
+/** @brief One timer-triggered sample. */
+typedef struct
+{
+    unsigned int tick;  /**< Trigger period the conversion was started in */
+    unsigned int value; /**< Conversion result */
+} ADCTimedSample;
+
+#if USE_ADC_TIMER_TRIGGER
+
+/** @brief Number of triggers that found the previous conversion still running. */
+extern volatile unsigned char ADCTriggerMissedCount;
+
+/** @brief Number of samples dropped because the ring buffer was full. */
+extern volatile unsigned char ADCTriggerOverrunCount;
+
+/**
+ * @brief Initialize timer-triggered sampling.
+ *
+ * Writes the trigger period into CCRA (STM) or CCRP (PTM) and enables the
+ * ADC interrupt. STimerInit() or PTimerInit() and ADCInit() must be called first.
+ */
+void ADCTriggerInit(void);
+
+/**
+ * @brief Power the ADC on ADC_TRIGGER_CHANNEL, reset the tick count and
+ * start triggering conversions.
+ *
+ * ReadADC() must not be used while triggering.
+ *
+ * @return 1 if triggering was started, 0 if the scan sequencer owns the ADC.
+ */
+unsigned char ADCTriggerStart(void);
+
+/**
+ * @brief Stop triggering conversions and power the ADC off.
+ */
+void ADCTriggerStop(void);
+
+/**
+ * @brief Get the number of samples waiting in the ring buffer.
+ *
+ * @return The number of unread samples.
+ */
+unsigned char ADCTriggerAvailable(void);
+
+/**
+ * @brief Take the oldest sample out of the ring buffer.
+ *
+ * @param sample Pointer to the sample to fill.
+ * @return 1 if a sample was taken, 0 if the ring buffer is empty.
+ */
+unsigned char ADCTriggerGetSample(ADCTimedSample *sample);
+
+/**
+ * @brief Trigger timer handler, starts the next conversion.
+ *
+ * Called from the STM comparator A or PTM comparator P interrupt vector.
+ */
+void ADCTriggerTimerISR(void);
+
+/**
+ * @brief ADC end-of-conversion handler, stores the sample with its tick.
+ *
+ * Called from the ADC interrupt vector (ADC_ISR_ADDRESS).
+ */
+void ADCTriggerADCISR(void);
+
+#endif
+
+#endif // ADC_TRIGGER_H_
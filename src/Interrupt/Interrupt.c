@@ -14,6 +14,11 @@
  */
 
 #include <Interrupt.h>
+#include "ADCScan.h"
+#include "ADCTrigger.h"
+#include "UART.h"
+#include "UARTAutoBaud.h"
+#include "Modbus.h"
 
 /** @brief Initializes the interrupts.
  * This function enables the global interrupt and configures individual interrupts
@@ -60,7 +65,9 @@ void IntrruptInit(void)
     #endif
 
     #if STM_COMPAIR_A_ISR
-        _stmae = STM_COMPAIR_A_ISR;
+        // Vector only: ADCTriggerStart() and ModbusInit() enable it once CCRA holds
+        // their period; with the STimerInit() default (CCRA = 1) it would fire constantly
+        _stmae = InterruptDisable;
     #endif
 
     #if BASE_TIMER0_ISR
@@ -298,12 +305,21 @@ void __attribute__((interrupt(EXTERNAL_PIN1_ISR_ADDRESS))) ExternalPin1ISR(void)
 
 /** @brief Universal Serial Interface Interrupt Service Routine.
  * This function handles the interrupt from Universal Serial Interface (USIM).
- * It is executed when an interrupt is triggered by the USIM.
+ * In UART mode it moves received bytes into the UART receive ring buffer
+ * and feeds the transmitter from the UART transmit ring buffer.
  */
 #if USIM_ISR
 void __attribute__((interrupt(USIM_ISR_ADDRESS))) UniversalSerialInterfaceISR(void)
 {
-    // Here goes the code for Universal Serial Interface ISR
+    #if USE_MODBUS_RTU
+        ModbusRxISR();
+    #elif USE_UART_RX_BUFFER
+        UART_RxISR();
+    #endif
+
+    #if USE_UART_TX_BUFFER
+        UART_TxISR();
+    #endif
 }
 #endif
 
@@ -318,6 +334,24 @@ void __attribute__((interrupt(LVD_ISR_ADDRESS))) LowVoltageDetectISR(void)
 }
 #endif
 
+/** @brief Analog to Digital Converter Interrupt Service Routine.
+ * This function handles the ADC end-of-conversion interrupt.
+ * It hands the finished conversion to the ADC scan sequencer or to the
+ * timer-triggered sampler, whichever of them is running.
+ */
+#if ADC_ISR
+void __attribute__((interrupt(ADC_ISR_ADDRESS))) ADConverterISR(void)
+{
+    #if USE_ADC_SCAN_SEQUENCER
+        ADCScanISR();
+    #endif
+
+    #if USE_ADC_TIMER_TRIGGER
+        ADCTriggerADCISR();
+    #endif
+}
+#endif
+
 /** @brief EEPROM Interrupt Service Routine.
  * This function handles the interrupt from EEPROM.
  * It is executed when an interrupt is triggered by the EEPROM.
@@ -337,6 +371,13 @@ void __attribute__((interrupt(EEPROM_ISR_ADDRESS))) EEPROMISR(void)
 void __attribute__((interrupt(PTM_COMPAIR_P_ISR_ADDRESS))) PTMCompairPISR(void)
 {
     // Here goes the code for PTM Comparator P ISR
+    #if USE_ADC_TIMER_TRIGGER && (ADC_TRIGGER_SOURCE == ADC_TRIGGER_PTM)
+        ADCTriggerTimerISR();
+    #endif
+
+    #if USE_UART_AUTOBAUD
+        UART_AutoBaudPeriodISR();
+    #endif
 }
 #endif
 
@@ -348,6 +389,9 @@ void __attribute__((interrupt(PTM_COMPAIR_P_ISR_ADDRESS))) PTMCompairPISR(void)
 void __attribute__((interrupt(PTM_COMPAIR_A_ISR_ADDRESS))) PTMCompairAISR(void)
 {
     // Here goes the code for PTM Comparator A ISR
+    #if USE_UART_AUTOBAUD
+        UART_AutoBaudCaptureISR();
+    #endif
 }
 #endif
 
@@ -370,6 +414,13 @@ void __attribute__((interrupt(STM_COMPAIR_P_ISR_ADDRESS))) STMCompairPISR(void)
 void __attribute__((interrupt(STM_COMPAIR_A_ISR_ADDRESS))) STMCompairAISR(void)
 {
     // Here goes the code for STM Comparator A ISR
+    #if USE_ADC_TIMER_TRIGGER && (ADC_TRIGGER_SOURCE == ADC_TRIGGER_STM)
+        ADCTriggerTimerISR();
+    #endif
+
+    #if USE_MODBUS_RTU
+        ModbusTimerISR();
+    #endif
 }
 #endif
 
@@ -39,14 +39,14 @@ extern char RXbit;
 // External interrupt settings
 #define EXTERNAL_PIN0_ISR      Disable
 #define EXTERNAL_PIN1_ISR      Disable
-#define USIM_ISR               Disable
+#define USIM_ISR               Enable
 #define LVD_ISR                Disable
-#define ADC_ISR                Disable
+#define ADC_ISR                Enable
 #define EEPROM_ISR             Disable
 #define PTM_COMPAIR_P_ISR      Enable
 #define PTM_COMPAIR_A_ISR      Enable
 #define STM_COMPAIR_P_ISR      Disable
-#define STM_COMPAIR_A_ISR      Disable
+#define STM_COMPAIR_A_ISR      Enable
 #define BASE_TIMER0_ISR        Disable
 #define BASE_TIMER1_ISR        Disable
 #define PLT_COMPAIR0_ISR       Enable
@@ -94,6 +94,9 @@ void __attribute__((interrupt(USIM_ISR_ADDRESS))) UniversalSerialInterfaceISR(vo
 /** @brief Low Voltage Detector Interrupt Service Routine. */
 void __attribute__((interrupt(LVD_ISR_ADDRESS))) LowVoltageDetectISR(void);
 
+/** @brief Analog to Digital Converter Interrupt Service Routine. */
+void __attribute__((interrupt(ADC_ISR_ADDRESS))) ADConverterISR(void);
+
 /** @brief EEPROM Interrupt Service Routine. */
 void __attribute__((interrupt(EEPROM_ISR_ADDRESS))) EEPROMISR(void);
 
@@ -0,0 +1,197 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file LineMonitor.c
+ * @brief Implementation of the LINEV waveform statistics engine.
+ *
+ * The interrupt side only adds, squares and compares. Samples are accumulated
+ * as differences from the previous window's mean, which keeps the mean term
+ * of the variance small so truncating it costs no accuracy. When a window ends
+ * the raw sums are latched into a snapshot that main code owns until it has
+ * read it, so the two sides never touch the same data at the same time.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "LineMonitor.h"
+
+#if USE_LINE_MONITOR
+
+// Running window, written by LineMonitorAddSample() only
+static unsigned int lineOffset;       // Mean of the previous window
+static long lineSum;                  // Sum of (sample - lineOffset)
+static unsigned long lineSumSquares;  // Sum of (sample - lineOffset)^2
+static unsigned int lineMin;
+static unsigned int lineMax;
+static unsigned int lineCount;
+
+// Snapshot of the last finished window, owned by main code while lineReady is set
+static unsigned int lineSnapshotOffset;
+static long lineSnapshotSum;
+static unsigned long lineSnapshotSumSquares;
+static unsigned int lineSnapshotMin;
+static unsigned int lineSnapshotMax;
+static volatile unsigned char lineReady;
+
+volatile unsigned char LineMonitorDroppedCount;
+
+/**
+ * @brief Integer square root of a 32-bit value.
+ *
+ * Bit-by-bit method, 16 iterations of shifts and subtractions.
+ *
+ * @param value The value to take the square root of.
+ * @return floor(sqrt(value)).
+ */
+static unsigned int LineMonitorSqrt(unsigned long value)
+{
+    unsigned long root = 0;
+    unsigned long bit = 1UL << 30;
+
+    while (bit)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (unsigned int)root;
+}
+
+/**
+ * @brief Clear the running window.
+ */
+static void LineMonitorStartWindow(void)
+{
+    lineSum = 0;
+    lineSumSquares = 0;
+    lineMin = 0xFFFF;
+    lineMax = 0;
+    lineCount = 0;
+}
+
+/**
+ * @brief Divide a signed sum by the window length.
+ *
+ * @param sum The signed sum.
+ * @param bits The shift count (window length or window length / 16).
+ * @return sum / 2^bits, rounded toward zero.
+ */
+static long LineMonitorShift(long sum, unsigned char bits)
+{
+    if (sum < 0)
+    {
+        return -(long)((unsigned long)(-sum) >> bits);
+    }
+    return (long)((unsigned long)sum >> bits);
+}
+
+/**
+ * @brief Reset the running window and drop any unread result.
+ */
+void LineMonitorInit(void)
+{
+    lineOffset = 0;
+    LineMonitorStartWindow();
+    lineReady = 0;
+    LineMonitorDroppedCount = 0;
+}
+
+/**
+ * @brief Add one sample to the running window.
+ *
+ * @param sample The ADC sample (12 bits).
+ */
+void LineMonitorAddSample(unsigned int sample)
+{
+    int delta = (int)sample - (int)lineOffset;
+
+    lineSum += delta;
+    lineSumSquares += (unsigned long)((long)delta * delta);
+
+    if (sample < lineMin)
+    {
+        lineMin = sample;
+    }
+    if (sample > lineMax)
+    {
+        lineMax = sample;
+    }
+
+    if (++lineCount < LINE_MONITOR_WINDOW)
+    {
+        return;
+    }
+
+    // Window finished, latch it unless main code still owns the snapshot
+    if (lineReady)
+    {
+        LineMonitorDroppedCount++;
+    }
+    else
+    {
+        lineSnapshotOffset = lineOffset;
+        lineSnapshotSum = lineSum;
+        lineSnapshotSumSquares = lineSumSquares;
+        lineSnapshotMin = lineMin;
+        lineSnapshotMax = lineMax;
+        lineReady = 1;
+    }
+
+    // Center the next window on this window's mean
+    lineOffset += (int)LineMonitorShift(lineSum, LINE_MONITOR_WINDOW_BITS);
+    LineMonitorStartWindow();
+}
+
+/**
+ * @brief Get the statistics of the last finished window.
+ *
+ * With d = sample - offset: mean = offset + sum(d) / N and
+ * RMS = sqrt(sum(d^2) / N - (sum(d) / N)^2). N is a power of two, so both
+ * divisions are shifts. The variance is formed in Q8 (mean difference in Q4)
+ * so the RMS keeps a fraction of a code of resolution before rounding.
+ *
+ * @param result Pointer to the result to fill.
+ * @return 1 if a new window result was returned, 0 if none is ready.
+ */
+unsigned char LineMonitorGetResult(LineMonitorResult *result)
+{
+    unsigned long squareMeanQ8;
+    unsigned long meanSquareQ8;
+    unsigned long meanDeltaQ4;
+
+    if (!lineReady)
+    {
+        return 0;
+    }
+
+    // sum(d^2) * 256 / N <= 256 * 4095^2, which still fits in 32 bits
+    squareMeanQ8 = lineSnapshotSumSquares << (8 - LINE_MONITOR_WINDOW_BITS);
+    meanDeltaQ4 = (unsigned long)((lineSnapshotSum < 0) ? -lineSnapshotSum : lineSnapshotSum);
+    meanDeltaQ4 = (meanDeltaQ4 << 4) >> LINE_MONITOR_WINDOW_BITS;
+    meanSquareQ8 = meanDeltaQ4 * meanDeltaQ4;
+
+    result->mean = lineSnapshotOffset + (int)LineMonitorShift(lineSnapshotSum, LINE_MONITOR_WINDOW_BITS);
+    result->rms = (squareMeanQ8 > meanSquareQ8) ? ((LineMonitorSqrt(squareMeanQ8 - meanSquareQ8) + 8) >> 4) : 0;
+    result->min = lineSnapshotMin;
+    result->max = lineSnapshotMax;
+    result->peakToPeak = lineSnapshotMax - lineSnapshotMin;
+
+    lineReady = 0; // Hand the snapshot back to the interrupt side
+    return 1;
+}
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file LineMonitor.h
+ * @brief Header file for the LINEV waveform statistics engine.
+ *
+ * The engine consumes one ADC sample at a time and keeps a running sum,
+ * sum of squares, minimum and maximum over a window of 2^n samples. At the
+ * end of every window it reports the DC mean, the AC RMS around that mean
+ * (integer square root) and the peak-to-peak value, all in ADC codes.
+ * Only 16/32-bit integer math is used and the window length is a power of
+ * two, so averaging is a shift and the per-sample work fits in the ADC interrupt.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef LINE_MONITOR_H
+#define LINE_MONITOR_H
+
+#define Enable  1
+#define Disable 0
+
+// Enable or Disable the line monitor
+#define USE_LINE_MONITOR         Enable
+
+// Window length as a power of two: 2^LINE_MONITOR_WINDOW_BITS samples.
+// With 12-bit samples the 32-bit sum of squares holds at most 256 samples.
+#define LINE_MONITOR_WINDOW_BITS 7
+#define LINE_MONITOR_WINDOW      (1 << LINE_MONITOR_WINDOW_BITS)
+
+#if LINE_MONITOR_WINDOW_BITS > 8
+#error "LINE_MONITOR_WINDOW_BITS must be 8 or less for 12-bit samples"
+#endif
+
+/** @brief Statistics of one finished window, in ADC codes. */
+typedef struct
+{
+    unsigned int rms;        /**< AC RMS around the mean */
+    unsigned int mean;       /**< DC mean */
+    unsigned int min;        /**< Lowest sample */
+    unsigned int max;        /**< Highest sample */
+    unsigned int peakToPeak; /**< max - min */
+} LineMonitorResult;
+
+#if USE_LINE_MONITOR
+
+/** @brief Number of finished windows dropped because the previous one was not read yet. */
+extern volatile unsigned char LineMonitorDroppedCount;
+
+/**
+ * @brief Reset the running window and drop any unread result.
+ */
+void LineMonitorInit(void);
+
+/**
+ * @brief Add one sample to the running window.
+ *
+ * Safe to call from the ADC interrupt. At the end of a window the sums are
+ * latched for LineMonitorGetResult() and a new window starts.
+ *
+ * @param sample The ADC sample (12 bits).
+ */
+void LineMonitorAddSample(unsigned int sample);
+
+/**
+ * @brief Get the statistics of the last finished window.
+ *
+ * The square root is computed here, in main code, not in the interrupt.
+ *
+ * @param result Pointer to the result to fill.
+ * @return 1 if a new window result was returned, 0 if none is ready.
+ */
+unsigned char LineMonitorGetResult(LineMonitorResult *result);
+
+#endif
+
+#endif // LINE_MONITOR_H
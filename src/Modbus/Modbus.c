@@ -0,0 +1,358 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file Modbus.c
+ * @brief Implementation of the Modbus RTU slave.
+ *
+ * The interrupts own the frame buffer until a checked frame is marked ready;
+ * from then on it belongs to ModbusService(), which builds the response in
+ * place. Bytes arriving before the response is queued are dropped.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "Modbus.h"
+
+#if USE_MODBUS_RTU
+
+#define MODBUS_BROADCAST_ADDRESS  0
+#define MODBUS_MIN_FRAME          4    // Address, function code and CRC
+#define MODBUS_DISCARD            0xFF // Frame length while dropping a frame
+
+// CRC-16/MODBUS of one nibble, reflected polynomial 0xA001, 32 bytes of ROM instead of 512
+static const unsigned int modbusCrcTable[16] = {
+    0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+    0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400
+};
+
+unsigned int modbusHoldingRegisters[MODBUS_HOLDING_REGISTERS];
+unsigned int modbusInputRegisters[MODBUS_INPUT_REGISTERS];
+
+static const ModbusBlock modbusMap[MODBUS_NUMBER_OF_BLOCKS] = MODBUS_REGISTER_MAP;
+
+static unsigned char modbusFrame[MODBUS_MAX_FRAME];
+static volatile unsigned char modbusLength;      // Bytes of the frame being received
+static volatile unsigned int modbusCrc;          // CRC of those bytes
+static volatile unsigned char modbusReady;       // Set at t3.5 when the frame checks out
+static volatile unsigned char modbusFrameLength; // Length of the ready frame, CRC included
+static volatile unsigned int modbusErrors;
+static unsigned char modbusWritten;
+
+/**
+ * @brief Update a CRC-16/MODBUS with one byte.
+ *
+ * @param crc CRC so far, 0xFFFF to start.
+ * @param data Next byte.
+ * @return The updated CRC.
+ */
+static unsigned int ModbusCrc(unsigned int crc, unsigned char data)
+{
+    crc = (crc >> 4) ^ modbusCrcTable[(crc ^ data) & 0x0F];
+    crc = (crc >> 4) ^ modbusCrcTable[(crc ^ (data >> 4)) & 0x0F];
+    return crc;
+}
+
+/**
+ * @brief Set up the STM as the t3.5 timer and wait for the first frame.
+ *
+ * The STM is cleared on comparator A match and stays off between frames;
+ * the first received byte starts it.
+ */
+void ModbusInit(void)
+{
+    _ston = 0;
+    _stpau = 0;
+    _stck0 = MODBUS_STM_CLOCK & 1;
+    _stck1 = (MODBUS_STM_CLOCK >> 1) & 1;
+    _stck2 = (MODBUS_STM_CLOCK >> 2) & 1;
+    _stm0 = STM_TIMER_COUNTER_MODE & 1;
+    _stm1 = (STM_TIMER_COUNTER_MODE >> 1) & 1;
+    _stcclr = STM_COMPARE_MATCH_A;
+    _stmal = MODBUS_T35_COUNTS & 0xFF;
+    _stmah = (MODBUS_T35_COUNTS >> 8) & 3;
+
+    modbusLength = 0;
+    modbusCrc = 0xFFFF;
+    modbusReady = 0;
+    modbusErrors = 0;
+    modbusWritten = 0;
+
+    _stmaf = 0;
+    _stmae = 1;
+}
+
+/**
+ * @brief Count one dropped frame.
+ */
+static void ModbusCountError(void)
+{
+    if (modbusErrors != 0xFFFF)
+    {
+        modbusErrors++;
+    }
+}
+
+/**
+ * @brief Store received bytes and restart the t3.5 timer.
+ *
+ * The CRC is updated byte by byte; over the whole frame, CRC included, it
+ * leaves a zero remainder.
+ */
+void ModbusRxISR(void)
+{
+    unsigned char length;
+    unsigned char data;
+
+    while (_urxif)
+    {
+        length = modbusLength;
+#if USE_UART_ERROR_STATS
+        if (UART_RxErrors())
+        {
+            length = MODBUS_DISCARD; // A damaged character spoils the whole frame
+        }
+#endif
+        data = _utxr_rxr;
+        _ston = 0; // Restart t3.5 from zero
+        _ston = 1;
+
+        if (modbusReady || length == MODBUS_DISCARD)
+        {
+            modbusLength = MODBUS_DISCARD; // Dropping this frame, or the previous one is not answered yet
+            continue;
+        }
+        if (length < MODBUS_MAX_FRAME)
+        {
+            modbusFrame[length] = data;
+            modbusCrc = ModbusCrc(modbusCrc, data);
+            modbusLength = length + 1;
+        }
+        else
+        {
+            modbusLength = MODBUS_DISCARD; // Too long
+        }
+    }
+}
+
+/**
+ * @brief End the frame after t3.5 of silence.
+ */
+void ModbusTimerISR(void)
+{
+    _ston = 0; // Wait for the next frame
+
+    if (modbusLength >= MODBUS_MIN_FRAME && modbusLength <= MODBUS_MAX_FRAME && modbusCrc == 0)
+    {
+        modbusFrameLength = modbusLength;
+        modbusReady = 1;
+    }
+    else if (modbusLength != 0)
+    {
+        ModbusCountError();
+    }
+
+    modbusLength = 0;
+    modbusCrc = 0xFFFF;
+}
+
+/**
+ * @brief Find registers in the map.
+ *
+ * The range has to lie inside one block.
+ *
+ * @param type MODBUS_HOLDING or MODBUS_INPUT.
+ * @param address First register address.
+ * @param quantity Number of registers.
+ * @return Pointer to the first register, or 0 if the range is not mapped.
+ */
+static unsigned int *ModbusFindRegisters(unsigned char type, unsigned int address, unsigned char quantity)
+{
+    unsigned char i;
+
+    for (i = 0; i < MODBUS_NUMBER_OF_BLOCKS; i++)
+    {
+        if (modbusMap[i].type == type && address >= modbusMap[i].address &&
+            address - modbusMap[i].address + quantity <= modbusMap[i].count)
+        {
+            return modbusMap[i].data + (address - modbusMap[i].address);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Turn the frame into an exception response.
+ *
+ * @return The response length without the CRC.
+ */
+static unsigned char ModbusException(unsigned char *frame, unsigned char code)
+{
+    frame[1] |= 0x80;
+    frame[2] = code;
+    return 3;
+}
+
+/**
+ * @brief Execute a request and build the response in its place.
+ *
+ * @param frame Request from the slave address on.
+ * @param length Request length without the CRC.
+ * @return The response length without the CRC.
+ */
+static unsigned char ModbusHandleRequest(unsigned char *frame, unsigned char length)
+{
+    unsigned char function = frame[1];
+    unsigned int address = ((unsigned int)frame[2] << 8) | frame[3];
+    unsigned int quantity = ((unsigned int)frame[4] << 8) | frame[5];
+    unsigned int *registers;
+    unsigned char *data;
+    unsigned char i;
+
+    switch (function)
+    {
+        case MODBUS_READ_HOLDING:
+        case MODBUS_READ_INPUT:
+            if (length != 6 || quantity < 1 || quantity > MODBUS_MAX_READ)
+            {
+                return ModbusException(frame, MODBUS_ILLEGAL_DATA_VALUE);
+            }
+            registers = ModbusFindRegisters(function == MODBUS_READ_HOLDING ? MODBUS_HOLDING : MODBUS_INPUT,
+                                            address, (unsigned char)quantity);
+            if (registers == 0)
+            {
+                return ModbusException(frame, MODBUS_ILLEGAL_DATA_ADDRESS);
+            }
+            frame[2] = (unsigned char)(quantity * 2);
+            data = frame + 3;
+            for (i = 0; i < (unsigned char)quantity; i++)
+            {
+                *data++ = (unsigned char)(registers[i] >> 8);
+                *data++ = (unsigned char)registers[i];
+            }
+            return 3 + frame[2];
+
+        case MODBUS_WRITE_SINGLE:
+            if (length != 6)
+            {
+                return ModbusException(frame, MODBUS_ILLEGAL_DATA_VALUE);
+            }
+            registers = ModbusFindRegisters(MODBUS_HOLDING, address, 1);
+            if (registers == 0)
+            {
+                return ModbusException(frame, MODBUS_ILLEGAL_DATA_ADDRESS);
+            }
+            *registers = quantity; // The value sits where the quantity would
+            modbusWritten = 1;
+            return 6; // Echo of the request
+
+        case MODBUS_WRITE_MULTIPLE:
+            if (length < 7 || quantity < 1 || quantity > MODBUS_MAX_WRITE ||
+                frame[6] != quantity * 2 || length != 7 + frame[6])
+            {
+                return ModbusException(frame, MODBUS_ILLEGAL_DATA_VALUE);
+            }
+            registers = ModbusFindRegisters(MODBUS_HOLDING, address, (unsigned char)quantity);
+            if (registers == 0)
+            {
+                return ModbusException(frame, MODBUS_ILLEGAL_DATA_ADDRESS);
+            }
+            data = frame + 7;
+            for (i = 0; i < (unsigned char)quantity; i++)
+            {
+                registers[i] = ((unsigned int)data[0] << 8) | data[1];
+                data += 2;
+            }
+            modbusWritten = 1;
+            return 6; // Address and quantity of the request
+
+        default:
+            return ModbusException(frame, MODBUS_ILLEGAL_FUNCTION);
+    }
+}
+
+/**
+ * @brief Answer a received frame, if any.
+ *
+ * Broadcast writes are executed without a response.
+ *
+ * @return 1 if a frame addressed to this slave was handled, 0 otherwise.
+ */
+unsigned char ModbusService(void)
+{
+    unsigned char length;
+    unsigned char sent;
+    unsigned char i;
+    unsigned int crc;
+
+    if (!modbusReady)
+    {
+        return 0;
+    }
+
+    if (modbusFrame[0] != MODBUS_SLAVE_ADDRESS && modbusFrame[0] != MODBUS_BROADCAST_ADDRESS)
+    {
+        modbusReady = 0; // For another slave
+        return 0;
+    }
+
+    length = ModbusHandleRequest(modbusFrame, modbusFrameLength - 2);
+
+    if (modbusFrame[0] != MODBUS_BROADCAST_ADDRESS)
+    {
+        crc = 0xFFFF;
+        for (i = 0; i < length; i++)
+        {
+            crc = ModbusCrc(crc, modbusFrame[i]);
+        }
+        modbusFrame[length++] = (unsigned char)crc; // Low byte first
+        modbusFrame[length++] = (unsigned char)(crc >> 8);
+
+        sent = 0;
+        while (sent < length)
+        {
+            sent += UART_Write(modbusFrame + sent, length - sent);
+        }
+    }
+
+    modbusReady = 0; // The buffer is free for the next request
+    return 1;
+}
+
+/**
+ * @brief Report and clear a write by the master.
+ *
+ * @return 1 if holding registers were written since the last call.
+ */
+unsigned char ModbusHoldingWritten(void)
+{
+    unsigned char written = modbusWritten;
+
+    modbusWritten = 0;
+    return written;
+}
+
+/**
+ * @brief Get the number of dropped frames.
+ *
+ * @return Frames dropped for CRC errors or length since ModbusInit(),
+ *         saturating at 0xFFFF.
+ */
+unsigned int ModbusErrorCount(void)
+{
+    unsigned int count;
+
+    // Read twice: the ISR can change the count between the two bytes
+    do
+    {
+        count = modbusErrors;
+    } while (count != modbusErrors);
+    return count;
+}
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file Modbus.h
+ * @brief Header file for the Modbus RTU slave.
+ *
+ * Frames are delimited by the 3.5 character silence (t3.5) measured by the
+ * STM: every received byte restarts the counter and the comparator A match
+ * (STM_COMPAIR_A_ISR) marks the end of the frame. The CRC-16 is updated in
+ * the USIM interrupt as each byte arrives, so at t3.5 the frame is already
+ * checked. ModbusService() then answers from the main loop, building the
+ * response in the frame buffer and queueing it on the UART TX ring.
+ *
+ * Registers are served from a ROM table of blocks, each mapping a range of
+ * Modbus addresses onto a RAM array. Function codes 3 (read holding),
+ * 4 (read input), 6 (write single) and 16 (write multiple) are supported,
+ * others are answered with exception 01.
+ *
+ * While the slave is enabled it owns the received bytes: UART_Read() and
+ * UARTFrame.h get nothing. The STM is used for t3.5 only, so the STM ADC
+ * trigger cannot run at the same time.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef MODBUS_H
+#define MODBUS_H
+
+#include "UART.h"
+#include "STM.h"
+#include "ADCTrigger.h"
+
+// Enable or Disable the Modbus RTU slave (needs the STM, see ADC_TRIGGER_SOURCE)
+#define USE_MODBUS_RTU            DISABLE
+
+#define MODBUS_SLAVE_ADDRESS      1
+
+// Largest frame, address to CRC; 256 in the standard, kept small for RAM
+#define MODBUS_MAX_FRAME          40
+
+// Register types
+#define MODBUS_HOLDING            0 /**< Read/write, function codes 3, 6, 16 */
+#define MODBUS_INPUT              1 /**< Read-only, function code 4 */
+
+/**
+ * @brief One register block of the map.
+ *
+ * @param address First Modbus register address.
+ * @param count Number of registers.
+ * @param data RAM array of count registers.
+ */
+#define MODBUS_HOLDING_BLOCK(address, count, data)  { (address), (count), MODBUS_HOLDING, (data) }
+#define MODBUS_INPUT_BLOCK(address, count, data)    { (address), (count), MODBUS_INPUT, (data) }
+
+// Registers served by the slave
+#define MODBUS_HOLDING_REGISTERS  8
+#define MODBUS_INPUT_REGISTERS    8
+#define MODBUS_REGISTER_MAP { \
+    MODBUS_HOLDING_BLOCK(0x0000, MODBUS_HOLDING_REGISTERS, modbusHoldingRegisters), \
+    MODBUS_INPUT_BLOCK(0x0000, MODBUS_INPUT_REGISTERS, modbusInputRegisters) \
+}
+#define MODBUS_NUMBER_OF_BLOCKS   2
+
+// Exception codes
+#define MODBUS_ILLEGAL_FUNCTION      0x01
+#define MODBUS_ILLEGAL_DATA_ADDRESS  0x02
+#define MODBUS_ILLEGAL_DATA_VALUE    0x03
+
+// Function codes
+#define MODBUS_READ_HOLDING          0x03
+#define MODBUS_READ_INPUT            0x04
+#define MODBUS_WRITE_SINGLE          0x06
+#define MODBUS_WRITE_MULTIPLE        0x10
+
+// Most registers per request that fit MODBUS_MAX_FRAME
+#define MODBUS_MAX_READ           ((MODBUS_MAX_FRAME - 5) / 2)
+#define MODBUS_MAX_WRITE          ((MODBUS_MAX_FRAME - 9) / 2)
+
+// t3.5 in microseconds: 3.5 characters of 11 bits, fixed at 1750 us above 19200 baud
+#if UART_BAUD_RATE > 19200UL
+    #define MODBUS_T35_US         1750UL
+#else
+    #define MODBUS_T35_US         ((38500000UL + UART_BAUD_RATE - 1) / UART_BAUD_RATE)
+#endif
+
+// Fastest STM clock that holds t3.5 in the 10-bit comparator
+#if (MODBUS_T35_US * (SYSTEM_CLOCK_HZ / 4 / 1000UL) + 999) / 1000 <= 1023
+    #define MODBUS_STM_CLOCK      ST_FSYS_DIVIDE_4
+    #define MODBUS_STM_CLOCK_HZ   (SYSTEM_CLOCK_HZ / 4)
+#elif (MODBUS_T35_US * (SYSTEM_CLOCK_HZ / 16 / 1000UL) + 999) / 1000 <= 1023
+    #define MODBUS_STM_CLOCK      ST_FH_DIVIDE_16
+    #define MODBUS_STM_CLOCK_HZ   (SYSTEM_CLOCK_HZ / 16)
+#else
+    #define MODBUS_STM_CLOCK      ST_FH_DIVIDE_64
+    #define MODBUS_STM_CLOCK_HZ   (SYSTEM_CLOCK_HZ / 64)
+#endif
+
+// STM counts for t3.5, rounded up
+#define MODBUS_T35_COUNTS         ((MODBUS_T35_US * (MODBUS_STM_CLOCK_HZ / 1000UL) + 999) / 1000)
+
+/** @brief One block of the register map. */
+typedef struct
+{
+    unsigned int address;  /**< First Modbus register address */
+    unsigned char count;   /**< Number of registers */
+    unsigned char type;    /**< MODBUS_HOLDING or MODBUS_INPUT */
+    unsigned int *data;    /**< Register values */
+} ModbusBlock;
+
+#if USE_MODBUS_RTU
+
+#if !USE_UART_TX_BUFFER
+#error "The Modbus slave needs USE_UART_TX_BUFFER"
+#endif
+#if USE_UART_MULTIDROP
+#error "Modbus RTU frames carry their own address, disable USE_UART_MULTIDROP"
+#endif
+#if USE_ADC_TIMER_TRIGGER && (ADC_TRIGGER_SOURCE == ADC_TRIGGER_STM)
+#error "The Modbus slave and the ADC trigger cannot share the STM"
+#endif
+#if MODBUS_T35_COUNTS > 1023
+#error "t3.5 does not fit the STM at this baud rate"
+#endif
+#if MODBUS_MAX_FRAME < 16 || MODBUS_MAX_FRAME > 254
+#error "MODBUS_MAX_FRAME must be 16..254"
+#endif
+
+extern unsigned int modbusHoldingRegisters[MODBUS_HOLDING_REGISTERS]; /**< Written by the master */
+extern unsigned int modbusInputRegisters[MODBUS_INPUT_REGISTERS];     /**< Filled by the application */
+
+/**
+ * @brief Set up the STM as the t3.5 timer and wait for the first frame.
+ *
+ * Call after UART_Init().
+ */
+void ModbusInit(void);
+
+/**
+ * @brief Answer a received frame, if any.
+ *
+ * Call from the main loop.
+ *
+ * @return 1 if a frame addressed to this slave was handled, 0 otherwise.
+ */
+unsigned char ModbusService(void);
+
+/**
+ * @brief Report and clear a write by the master.
+ *
+ * @return 1 if holding registers were written since the last call.
+ */
+unsigned char ModbusHoldingWritten(void);
+
+/**
+ * @brief Get the number of dropped frames.
+ *
+ * @return Frames dropped for CRC errors or length since ModbusInit(),
+ *         saturating at 0xFFFF.
+ */
+unsigned int ModbusErrorCount(void);
+
+/**
+ * @brief Store received bytes and restart the t3.5 timer.
+ *
+ * Call from the USIM interrupt service routine.
+ */
+void ModbusRxISR(void);
+
+/**
+ * @brief End the frame after t3.5 of silence.
+ *
+ * Call from the STM comparator A interrupt service routine.
+ */
+void ModbusTimerISR(void);
+
+#endif
+
+#endif // MODBUS_H
@@ -18,39 +18,150 @@
 
 #include "NTC.h"
 
+#define NTC_LN2_Q16  45426UL // ln(2) * 65536
+
 
 #if TEMPERATURE_CALCULATION_METHOD == USE_LOOKUP_TABLE
-   // Lookup tables for temperature and resistance values
-	static const float temperatureLookupTable[] = {
-	    -50.0, -40.0, -30.0, -20.0, -10.0, -5.0, 0.0, 5.0, 10.0, 15.0, 20.0, 25.0, 30.0, 35.0, 40.0, 45.0, 50.0, 55.0, 60.0
+   // Lookup tables for temperature (0.1 degC) and resistance (ohms) values.
+   // Resistance must be strictly decreasing.
+	static const int temperatureLookupTable[] = {
+	    -500, -400, -300, -200, -100, -50, 0, 50, 100, 150, 200, 250, 300, 350, 400, 450, 500, 550, 600
 	};
-	static const  float resistanceLookupTable[] = {
-	    1500.0, 820.0, 470.0, 270.0, 150.0, 100.0, 75.0, 50.0, 35.0, 25.0, 18.0, 10.0, 8.0, 6.0, 4.7, 3.6, 3.0, 2.2, 1.8
+	static const unsigned long resistanceLookupTable[] = {
+	    1500000, 820000, 470000, 270000, 150000, 100000, 75000, 50000, 35000, 25000, 18000, 10000, 8000, 6000, 4700, 3600, 3000, 2200, 1800
 	};
 	#define TABLE_SIZE 19// Size of the lookup tables
 	  /**
      * @brief Get temperature from resistance using a lookup table.
      * 
-     * This function interpolates between known resistance values to find the 
-     * corresponding temperature.
+     * A binary search finds the two entries around the resistance in
+     * log2(TABLE_SIZE) steps, then the temperature is interpolated between
+     * them with 32-bit integer math.
      * 
-     * @param resistance The resistance of the NTC thermistor.
-     * @return The interpolated temperature in Celsius or -999.0 if out of range.
+     * @param resistance The resistance of the NTC thermistor in ohms.
+     * @return The interpolated temperature in 0.1 degC or NTC_LOOKUP_OUT_OF_RANGE.
      */	
-	float GetTemperatureFromLookup(unsigned long resistance) {
-	    int i;
+	int GetTemperatureFromLookup(unsigned long resistance) {
+	    unsigned char low = 0, high = TABLE_SIZE - 1, middle;
+	    unsigned long span, offset;
+	    unsigned int step;
+
 		// Check for resistance out of bounds
-	    if (resistance < 1.8 || resistance > 1500.0) return -999.0;
-	    for (i = 0; i < TABLE_SIZE - 1; i++) {
-	        if (resistance >= resistanceLookupTable[i + 1] && resistance <= resistanceLookupTable[i]) {
-	            float temp1 = temperatureLookupTable[i] , 
-	                  temp2 = temperatureLookupTable[i + 1],
-	                  resistance1 =resistanceLookupTable[i],
-	                  resistance2 =resistanceLookupTable[i + 1];
-	            return (temp1 + (resistance - resistance1) * (temp2 - temp1) / (resistance2 - resistance1));
-	        }
+	    if (resistance < resistanceLookupTable[TABLE_SIZE - 1] || resistance > resistanceLookupTable[0]) return NTC_LOOKUP_OUT_OF_RANGE;
+
+	    // Keep resistanceLookupTable[low] >= resistance >= resistanceLookupTable[high]
+	    while (high - low > 1) {
+	        middle = (low + high) >> 1;
+	        if (resistance > resistanceLookupTable[middle]) high = middle;
+	        else low = middle;
 	    }
-	    return -999.0;// Return -999.0 if no match found
+
+	    span = resistanceLookupTable[low] - resistanceLookupTable[high];
+	    offset = resistanceLookupTable[low] - resistance;
+	    step = (unsigned int)(temperatureLookupTable[high] - temperatureLookupTable[low]);
+	    return temperatureLookupTable[low] + (int)((offset * step + (span >> 1)) / span);
+	}
+
+#elif TEMPERATURE_CALCULATION_METHOD == USE_CODE_TABLE
+	#include "NTCTable.h"
+
+	#if (NTC_TABLE_FIXED_RESISTOR != NTC_FIXED_RESISTOR) || (NTC_TABLE_TOPOLOGY != NTC_TOPOLOGY)
+	#error "NTCTable.h was generated for a different divider, regenerate it"
+	#endif
+	#if (NTC_TABLE_MAX_DELTA << NTC_TABLE_STEP_BITS) > 65535
+	#error "NTC table steps are too large for 16-bit interpolation, lower NTC_TABLE_STEP_BITS"
+	#endif
+	#if (NTC_TABLE_MAX_CODE >> NTC_TABLE_STEP_BITS) > 255
+	#error "NTC table has more entries than an 8-bit index reaches, raise NTC_TABLE_STEP_BITS"
+	#endif
+
+	/**
+	 * @brief Get temperature from an ADC code using the precomputed code table.
+	 *
+	 * The upper bits of the code select a table entry and the lower bits
+	 * interpolate linearly towards the next one.
+	 *
+	 * @param ADCValue The ADC value corresponding to the voltage across the NTC.
+	 * @return The temperature in 0.1 degC.
+	 */
+	int GetTemperatureFromCode(unsigned int ADCValue) {
+		unsigned char index;
+		unsigned int fraction;
+		int low, high;
+
+		if (ADCValue > NTC_TABLE_MAX_CODE) ADCValue = NTC_TABLE_MAX_CODE;
+		index = (unsigned char)(ADCValue >> NTC_TABLE_STEP_BITS);
+		fraction = ADCValue & ((1 << NTC_TABLE_STEP_BITS) - 1);
+		low = ntcCodeTable[index];
+		high = ntcCodeTable[index + 1];
+
+		// Interpolate on the unsigned difference so the shift never sees a negative value
+		if (high < low) {
+			return low - (int)(((unsigned int)(low - high) * fraction) >> NTC_TABLE_STEP_BITS);
+		}
+		return low + (int)(((unsigned int)(high - low) * fraction) >> NTC_TABLE_STEP_BITS);
+	}
+
+#elif TEMPERATURE_CALCULATION_METHOD == USE_BETA
+	/**
+	 * @brief Get temperature from resistance using the Beta equation.
+	 *
+	 * With ln in Q12 the denominator Beta/T25 + ln(R/R25) stays below 2^31
+	 * and 81920 * Beta / denominator is the temperature in 0.05 K.
+	 *
+	 * @param resistance The resistance of the NTC thermistor in ohms.
+	 * @return The temperature in 0.1 degC, or NTC_BETA_OUT_OF_RANGE.
+	 */
+	int GetTemperatureFromBeta(unsigned long resistance) {
+		long denominator;
+		long halfKelvin;
+
+		if (resistance == 0 || resistance == 0xFFFFFFFFUL) return NTC_BETA_OUT_OF_RANGE; // Shorted or open
+
+		// ln(R) - ln(R25) cancels most of the NTCLnQ16() table error
+		denominator = (long)NTC_BETA_T25_Q12 + (long)(NTCLnQ16(resistance) >> 4) - (long)(NTCLnQ16(NTC_R25_OHMS) >> 4);
+		if (denominator <= 0) return NTC_BETA_OUT_OF_RANGE;
+
+		halfKelvin = (long)((NTC_BETA * 81920UL + ((unsigned long)denominator >> 1)) / (unsigned long)denominator) - 5463; // 273.15 K
+		if (halfKelvin > 65000L) return NTC_BETA_OUT_OF_RANGE;
+
+		// 0.05 degC to 0.1 degC, rounded away from zero
+		return (int)((halfKelvin + ((halfKelvin >= 0) ? 1 : -1)) / 2);
+	}
+
+#elif TEMPERATURE_CALCULATION_METHOD == USE_PIECEWISE_LINEAR
+	#include "NTCBreakpoints.h"
+
+	#if (NTC_BREAKPOINTS_FIXED_RESISTOR != NTC_FIXED_RESISTOR) || (NTC_BREAKPOINTS_TOPOLOGY != NTC_TOPOLOGY)
+	#error "NTCBreakpoints.h was generated for a different divider, regenerate it"
+	#endif
+
+	/**
+	 * @brief Get temperature from an ADC code using piecewise-linear breakpoints.
+	 *
+	 * @param ADCValue The ADC value corresponding to the voltage across the NTC.
+	 * @return The temperature in 0.1 degC.
+	 */
+	int GetTemperatureFromBreakpoints(unsigned int ADCValue) {
+		unsigned char low = 0, high = NTC_BREAKPOINT_COUNT, middle;
+		const NTCBreakpoint *segment;
+		long delta;
+
+		if (ADCValue > NTC_BREAKPOINTS_MAX_CODE) ADCValue = NTC_BREAKPOINTS_MAX_CODE;
+
+		// Last breakpoint at or below the code; ntcBreakpoints[0].code is 0
+		while (high - low > 1) {
+			middle = (low + high) >> 1;
+			if (ADCValue < ntcBreakpoints[middle].code) high = middle;
+			else low = middle;
+		}
+
+		segment = &ntcBreakpoints[low];
+		delta = (long)segment->slope * (int)(ADCValue - segment->code);
+
+		// Shift the magnitude so rounding matches the generator on both signs
+		if (delta < 0) return segment->temperature - (int)((-delta) >> 8);
+		return segment->temperature + (int)(delta >> 8);
 	}
 
 #elif TEMPERATURE_CALCULATION_METHOD == USE_STENINHART
@@ -88,6 +199,26 @@
 		
 		    return 2 * result;
 		}
+	#elif CALCULATE_STENINHART_LOGARITM_LIBRARY == USE_FIXED_POINT_LOG
+		/**
+		 * @brief Natural logarithm through the fixed-point NTCLnQ16().
+		 *
+		 * Values below 65536 are scaled by 2^16 first so fractional inputs keep
+		 * their resolution; the scale is removed as 16 * ln(2). The error stays
+		 * below 0.0006 for x >= 1.
+		 *
+		 * @param x The input value for which the logarithm is to be calculated.
+		 * @return The natural logarithm of the input value.
+		 */
+		float fixed_log(float x) {
+			if (x <= 0) {
+				return -1.0; // Logarithm is not defined for non-positive numbers
+			}
+			if (x >= 65536.0) {
+				return NTCLnQ16((unsigned long)x) * (1.0 / 65536.0);
+			}
+			return (long)(NTCLnQ16((unsigned long)(x * 65536.0)) - NTC_LN2_Q16 * 16) * (1.0 / 65536.0);
+		}
 	#endif
 		/**
 		 * @brief Get temperature from resistance using the Steinhart-Hart equation.
@@ -95,18 +226,94 @@
 		 * This function computes the temperature in Kelvin and converts it to Celsius 
 		 * using the Steinhart-Hart coefficients.
 		 * 
-		 * @param resistance The resistance of the NTC thermistor.
+		 * @param resistance The resistance of the NTC thermistor in ohms.
 		 * @return The calculated temperature in Celsius.
 		 */
 		float GetTemperatureFromSteinhart(float resistance) {
 			
 		    float logResistance = LOG_FUNCTION(resistance);
 		    float temperatureK = 1.0 / (A + B * logResistance + C * logResistance * logResistance * logResistance);
-		    return  (temperatureK - 273.15)/10.0;// Convert Kelvin to Celsius
+		    return  temperatureK - 273.15;// Convert Kelvin to Celsius
 		   
 		}
 #endif
 
+// log2(1 + i/16) in Q16, i = 0..16
+static const unsigned int ntcLog2Table[17] = {
+    0, 5732, 11136, 16248, 21098, 25711, 30109, 34312, 38336,
+    42196, 45904, 49472, 52911, 56229, 59434, 62534, 65535
+};
+
+/**
+ * @brief Natural logarithm in Q16 fixed point.
+ *
+ * x is shifted so its leading one lands on bit 31; the shift count gives the
+ * integer part of log2(x). Bits 30..27 pick a table segment and bits 26..11
+ * interpolate inside it. ln(x) = log2(x) * ln(2).
+ *
+ * @param x The input value, at least 1.
+ * @return ln(x) * 65536, or 0 for x = 0.
+ */
+unsigned long NTCLnQ16(unsigned long x) {
+	unsigned char exponent = 31;
+	unsigned char index;
+	unsigned int fraction, low;
+
+	if (x == 0) return 0;
+
+	// Normalize in five fixed steps instead of a bit-by-bit loop
+	if (!(x & 0xFFFF0000UL)) { x <<= 16; exponent -= 16; }
+	if (!(x & 0xFF000000UL)) { x <<= 8;  exponent -= 8; }
+	if (!(x & 0xF0000000UL)) { x <<= 4;  exponent -= 4; }
+	if (!(x & 0xC0000000UL)) { x <<= 2;  exponent -= 2; }
+	if (!(x & 0x80000000UL)) { x <<= 1;  exponent -= 1; }
+
+	index = (unsigned char)(x >> 27) & 0x0F;
+	fraction = (unsigned int)(x >> 11) & 0xFFFF;
+	low = ntcLog2Table[index];
+	low += (unsigned int)(((unsigned long)(ntcLog2Table[index + 1] - low) * fraction) >> 16);
+
+	// log2 fraction * ln(2) fits in 32 bits, the integer part is added separately
+	return exponent * NTC_LN2_Q16 + (((unsigned long)low * NTC_LN2_Q16 + 0x8000UL) >> 16);
+}
+
+/**
+ * @brief Calculate the resistance of any NTC divider from an ADC value.
+ *
+ * R = code * Rfixed / (full scale - code) for a pull-down NTC and
+ * R = (full scale - code) * Rfixed / code for a pull-up NTC, rounded.
+ *
+ * @param ADCValue The ADC value corresponding to the voltage across the NTC.
+ * @param topology NTC_IS_PULLDOWN or NTC_IS_PULLUP.
+ * @param fixedResistor The fixed divider resistor in ohms.
+ * @return The NTC resistance in ohms, 0xFFFFFFFF for an open NTC.
+ */
+unsigned long NTCDividerResistance(unsigned int ADCValue, unsigned char topology, unsigned long fixedResistor) {
+	unsigned int numerator, denominator;
+
+	if (ADCValue >= NTC_ADC_FULL_SCALE) ADCValue = NTC_ADC_FULL_SCALE;
+	if (topology == NTC_IS_PULLDOWN) {
+		numerator = ADCValue;
+		denominator = NTC_ADC_FULL_SCALE - ADCValue;
+	} else {
+		numerator = NTC_ADC_FULL_SCALE - ADCValue;
+		denominator = ADCValue;
+	}
+
+	if (denominator == 0) return 0xFFFFFFFFUL; // Open NTC
+	return (numerator * fixedResistor + (denominator >> 1)) / denominator;
+}
+
+/**
+ * @brief Calculate the NTC resistance from an ADC value with integer math.
+ *
+ * @param ADCValue The ADC value corresponding to the voltage across the NTC.
+ * @return The NTC resistance in ohms, 0xFFFFFFFF for an open NTC.
+ */
+unsigned long NTCResistance(unsigned int ADCValue) {
+	return NTCDividerResistance(ADCValue, NTC_TOPOLOGY, NTC_FIXED_RESISTOR_OHMS);
+}
+
 /**
  * @brief Calculate the temperature in Celsius from an ADC value and supply voltage (VDD).
  * 
@@ -119,21 +326,29 @@
  * @return The calculated temperature in Celsius.
  */
 float temperature(unsigned int ADCValue, float VDD) {
+#if TEMPERATURE_CALCULATION_METHOD == USE_CODE_TABLE
+	// The code table already folds in the divider, VDD cancels out
+	return GetTemperatureFromCode(ADCValue) * 0.1;
+#elif TEMPERATURE_CALCULATION_METHOD == USE_LOOKUP_TABLE
+	// Integer resistance straight from the code, VDD cancels out
+	return GetTemperatureFromLookup(NTCResistance(ADCValue)) * 0.1;
+#elif TEMPERATURE_CALCULATION_METHOD == USE_BETA
+	// Integer resistance and Beta equation, VDD cancels out
+	return GetTemperatureFromBeta(NTCResistance(ADCValue)) * 0.1;
+#elif TEMPERATURE_CALCULATION_METHOD == USE_PIECEWISE_LINEAR
+	// The breakpoints already fold in the divider, VDD cancels out
+	return GetTemperatureFromBreakpoints(ADCValue) * 0.1;
+#else
 	//if((ADCValue<=0)||(ADCValue>4098))ADCValue=0;
 	// Calculate the voltage across the NTC using the provided macros/functions.
 	float VNTC = CALCULATE_VNTC(ADCValue, ADCNumerOfBits, VDD);
 	
 	// Calculate the resistance of the NTC using the provided macros/functions.
-	float RNTC = CALCULATE_RNTC(VNTC, VDD, RES_CONNECTED_TO_NTC);
+	// The Steinhart-Hart coefficients are fitted to ohms
+	float RNTC = CALCULATE_RNTC(VNTC, VDD, NTC_FIXED_RESISTOR_OHMS);
 	
-	#if TEMPERATURE_CALCULATION_METHOD ==  USE_LOOKUP_TABLE
-        return GetTemperatureFromLookup(RNTC);
-    #elif TEMPERATURE_CALCULATION_METHOD == USE_STENINHART
-    /*	#if CALCULATE_STENINHART_LOGARITM_LIBRARY == USE_MATH_H
-     		RNTC=RNTC*1000;
-     	#endif*/
-/*        RNTC=RNTC*1000;*/
+	#if TEMPERATURE_CALCULATION_METHOD == USE_STENINHART
         return GetTemperatureFromSteinhart(RNTC);
     #endif 
-   
+#endif
 }
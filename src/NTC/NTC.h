@@ -21,9 +21,10 @@
 #define NTC_H
 
 #include "BA45F5240.h"
+#include "ADC.h"
 
 // ADC resolution definitions
-#define ADC_12bit  4094.0  // Maximum ADC value for 12-bit resolution
+#define ADC_12bit  ADC_FULL_SCALE  // Maximum ADC value for 12-bit resolution, from ADC.h
 #define ADC_10bit  1023.0   // Maximum ADC value for 10-bit resolution
 #define ADC_8bit   255.0    // Maximum ADC value for 8-bit resolution
 #define ADCNumerOfBits  ADC_12bit // Define the number of bits used for ADC
@@ -35,12 +36,20 @@
 // Temperature calculation method selection
 #define USE_STENINHART    0
 #define USE_LOOKUP_TABLE  1
+#define USE_CODE_TABLE    2 /**< Integer table indexed by ADC code, see NTCTable.h */
+#define USE_BETA          3 /**< Integer Beta equation, see NTC_BETA */
+#define USE_PIECEWISE_LINEAR  4 /**< Integer segments between breakpoints, see NTCBreakpoints.h */
+#ifndef TEMPERATURE_CALCULATION_METHOD // May be set by the build, e.g. tools/NTCBench
 #define TEMPERATURE_CALCULATION_METHOD     USE_STENINHART 
+#endif
 
 // Logarithm function selection for Steinhart-Hart calculations
 #define USE_MATH_H   0
 #define USE_CUSTOM_LOG_FUNCTION  1
+#define USE_FIXED_POINT_LOG      2 /**< Constant-time table log, see NTCLnQ16() */
+#ifndef CALCULATE_STENINHART_LOGARITM_LIBRARY
 #define CALCULATE_STENINHART_LOGARITM_LIBRARY   USE_MATH_H
+#endif
 
 // NTC configuration definitions
 #define NTC_IS_PULLDOWN  0 /**< NTC is in pull-down configuration (NTC to GND, resistor to VCC) */
@@ -49,15 +58,90 @@
 
 // Resistor value in kO used in the NTC circuit
 #define NTC_FIXED_RESISTOR  10  /**< Fixed resistor value in kO **/
+#define NTC_FIXED_RESISTOR_OHMS  (NTC_FIXED_RESISTOR * 1000UL) /**< Fixed resistor value in ohms */
+
+// Integer ADC full-scale code matching ADCNumerOfBits
+#define NTC_ADC_FULL_SCALE  ((unsigned int)ADCNumerOfBits)
 
 
 #if TEMPERATURE_CALCULATION_METHOD == USE_LOOKUP_TABLE
-	float GetTemperatureFromLookup(unsigned long resistance);
+	#define NTC_LOOKUP_OUT_OF_RANGE  (-9990) /**< Returned for a resistance outside the table (-999.0 degC) */
+
+	/**
+	 * @brief Get temperature from resistance using the resistance lookup table.
+	 *
+	 * Binary search over the ROM table and integer interpolation.
+	 *
+	 * @param resistance The resistance of the NTC thermistor in ohms.
+	 * @return The temperature in 0.1 degC, or NTC_LOOKUP_OUT_OF_RANGE.
+	 */
+	int GetTemperatureFromLookup(unsigned long resistance);
+#elif TEMPERATURE_CALCULATION_METHOD == USE_CODE_TABLE
+	// One table entry every 2^NTC_TABLE_STEP_BITS ADC codes (4..7).
+	// 6 gives 65 entries and stays within 0.35 degC of Steinhart-Hart from -30 to 100 degC.
+	// NTCTable.h defines the step it was generated for; define it here only to pick another.
+
+	/**
+	 * @brief Get temperature from an ADC code using the precomputed code table.
+	 *
+	 * One table read and an integer interpolation, no float and no logarithm.
+	 * The divider is ratiometric, so VDD is not needed.
+	 *
+	 * @param ADCValue The ADC value corresponding to the voltage across the NTC.
+	 * @return The temperature in 0.1 degC, clamped to NTC_TABLE_MIN..NTC_TABLE_MAX.
+	 */
+	int GetTemperatureFromCode(unsigned int ADCValue);
+#elif TEMPERATURE_CALCULATION_METHOD == USE_BETA
+	// Beta model from the NTC datasheet: 1/T = 1/T25 + ln(R/R25)/Beta
+	#define NTC_BETA       3950UL  /**< Beta value (B25/85), kelvin */
+	#define NTC_R25_OHMS   10000UL /**< Resistance at 25 degC, ohms */
+	#define NTC_BETA_OUT_OF_RANGE  (-9990) /**< Returned for an open or shorted NTC (-999.0 degC) */
+
+	// Beta / 298.15 K in Q12, the 1/T25 term scaled by Beta
+	#define NTC_BETA_T25_Q12  ((NTC_BETA * 409600UL + 14907UL) / 29815UL)
+
+	#if NTC_BETA > 10000UL
+	#error "NTC_BETA is too large for the 32-bit Beta equation"
+	#endif
+
+	/**
+	 * @brief Get temperature from resistance using the Beta equation.
+	 *
+	 * T = Beta / (Beta / T25 + ln(R) - ln(R25)) with NTCLnQ16() and one
+	 * 32-bit division, no float. Coarser than Steinhart-Hart away from the
+	 * 25 degC / 85 degC points Beta was specified for.
+	 *
+	 * @param resistance The resistance of the NTC thermistor in ohms.
+	 * @return The temperature in 0.1 degC, or NTC_BETA_OUT_OF_RANGE.
+	 */
+	int GetTemperatureFromBeta(unsigned long resistance);
+#elif TEMPERATURE_CALCULATION_METHOD == USE_PIECEWISE_LINEAR
+	/** @brief Start of one linear segment of the ADC code to temperature curve. */
+	typedef struct {
+		unsigned int code;   /**< First ADC code of the segment */
+		int temperature;     /**< Temperature at code, 0.1 degC */
+		int slope;           /**< 0.1 degC per ADC code, Q8 */
+	} NTCBreakpoint;
+
+	/**
+	 * @brief Get temperature from an ADC code using piecewise-linear breakpoints.
+	 *
+	 * Breakpoints are only stored where the curve bends, so a few dozen cover
+	 * the whole range within the error bound NTCBreakpoints.h was generated for.
+	 * A binary search finds the segment, then one 16x16-bit multiply.
+	 *
+	 * @param ADCValue The ADC value corresponding to the voltage across the NTC.
+	 * @return The temperature in 0.1 degC.
+	 */
+	int GetTemperatureFromBreakpoints(unsigned int ADCValue);
 #elif TEMPERATURE_CALCULATION_METHOD == USE_STENINHART
 
 	#if CALCULATE_STENINHART_LOGARITM_LIBRARY == USE_MATH_H
 		#include <math.h>
 		#define LOG_FUNCTION log
+	#elif CALCULATE_STENINHART_LOGARITM_LIBRARY == USE_FIXED_POINT_LOG
+		float fixed_log(float x); /**< Natural logarithm through NTCLnQ16() **/
+		#define LOG_FUNCTION fixed_log
 /*	#elif CALCULATE_STENINHART_LOGARITM_LIBRARY == USE_CUSTOM_LOG_FUNCTION*/
 	#else
 		float custom_log(float x); /**< Function prototype for custom logarithm function **/
@@ -119,10 +203,43 @@
  * @param VCC The supply voltage.
  * @return The calculated voltage across the NTC.
  */
-#define CALCULATE_VNTC(ADC_NTC, ADCNumerOfbits, VCC)((ADC_NTC/ADCNumerOfbits)*VCC)
+#define CALCULATE_VNTC(ADC_NTC, ADCNumerOfbits, VCC)(((float)(ADC_NTC)/(ADCNumerOfbits))*VCC)
  
 
 
+/**
+ * @brief Natural logarithm in Q16 fixed point.
+ *
+ * Runs in a constant number of steps: a 5-step binary search normalizes the
+ * input by its leading bit, then a 17-entry log2 table is interpolated
+ * linearly. Absolute error is below 0.0006 (about 40 LSB of Q16) for every
+ * input, which moves a Steinhart-Hart temperature by less than 0.02 degC.
+ *
+ * @param x The input value, at least 1.
+ * @return ln(x) * 65536, or 0 for x = 0.
+ */
+unsigned long NTCLnQ16(unsigned long x);
+
+/**
+ * @brief Calculate the resistance of any NTC divider from an ADC value.
+ *
+ * @param ADCValue The ADC value corresponding to the voltage across the NTC.
+ * @param topology NTC_IS_PULLDOWN or NTC_IS_PULLUP.
+ * @param fixedResistor The fixed divider resistor in ohms.
+ * @return The NTC resistance in ohms, 0xFFFFFFFF for an open NTC.
+ */
+unsigned long NTCDividerResistance(unsigned int ADCValue, unsigned char topology, unsigned long fixedResistor);
+
+/**
+ * @brief Calculate the NTC resistance from an ADC value with integer math.
+ *
+ * The divider is ratiometric, so VDD is not needed.
+ *
+ * @param ADCValue The ADC value corresponding to the voltage across the NTC.
+ * @return The NTC resistance in ohms, 0xFFFFFFFF for an open NTC.
+ */
+unsigned long NTCResistance(unsigned int ADCValue);
+
 /**
  * @brief Calculate the temperature in Celsius from an ADC value and VDD voltage.
  * 
@@ -136,6 +253,18 @@
 
 float temperature(unsigned int ADCValue, float VDD);
 
+/**
+ * @brief Calculate the temperature of a ratiometric divider.
+ *
+ * Only valid when the divider is fed from VDD, the ADC reference: VDD then
+ * cancels out, so a unit VDD is passed and no VBGREF reading is needed. A
+ * divider fed from any other source must call temperature() with its voltage.
+ *
+ * @param ADCValue The ADC value corresponding to the voltage across the NTC.
+ * @return The calculated temperature in Celsius.
+ */
+#define TEMPERATURE_RATIOMETRIC(ADCValue) temperature((ADCValue), 1.0)
+
 
 
 #endif /* NTC_H */
@@ -0,0 +1,68 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file NTCBreakpoints.h
+ * @brief Piecewise-linear breakpoints for the USE_PIECEWISE_LINEAR backend.
+ *
+ * Each breakpoint starts a segment at an ADC code with its temperature in
+ * 0.1 degC and a slope in 0.1 degC / 256 per code. Spacing follows the
+ * curvature, so every code stays within 0.20 degC of the model (clamped
+ * to -400..1250). Do not edit; regenerate with tools/NTCTableGen.
+ *
+ * Generated from:
+ *   A = 0.001277368779, B = 0.000208223231, C = 2.032989311e-07
+ *   Fixed resistor = 10000 ohm, NTC_IS_PULLDOWN, full scale = 4095
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef NTC_BREAKPOINTS_H
+#define NTC_BREAKPOINTS_H
+
+// Divider the breakpoints were generated for, checked against NTC.h
+#define NTC_BREAKPOINTS_FIXED_RESISTOR  10
+#define NTC_BREAKPOINTS_TOPOLOGY        NTC_IS_PULLDOWN
+
+// Highest ADC code, ADCNumerOfBits rounded up to whole bits
+#define NTC_BREAKPOINTS_MAX_CODE  4095
+
+#define NTC_BREAKPOINT_COUNT  29
+static const NTCBreakpoint ntcBreakpoints[NTC_BREAKPOINT_COUNT] = {
+    {    0,  1250,    -6 },
+    {  125,  1247,  -723 },
+    {  142,  1199,  -601 },
+    {  165,  1145,  -512 },
+    {  197,  1081,  -422 },
+    {  231,  1025,  -353 },
+    {  268,   974,  -303 },
+    {  312,   922,  -256 },
+    {  373,   861,  -213 },
+    {  433,   811,  -183 },
+    {  503,   761,  -157 },
+    {  586,   710,  -136 },
+    {  684,   658,  -116 },
+    {  794,   608,  -102 },
+    {  922,   557,   -90 },
+    { 1067,   506,   -79 },
+    { 1265,   445,   -70 },
+    { 1511,   378,   -63 },
+    { 1805,   306,   -59 },
+    { 2093,   240,   -58 },
+    { 2578,   131,   -62 },
+    { 3006,    28,   -72 },
+    { 3298,   -54,   -88 },
+    { 3519,  -130,  -111 },
+    { 3674,  -197,  -141 },
+    { 3785,  -258,  -181 },
+    { 3867,  -316,  -230 },
+    { 3927,  -370,  -284 },
+    { 3954,  -400,     0 }
+};
+
+#endif // NTC_BREAKPOINTS_H
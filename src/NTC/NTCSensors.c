@@ -0,0 +1,243 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file NTCSensors.c
+ * @brief Implementation of the multi-sensor NTC manager.
+ *
+ * The resistance is computed with integer math and the logarithm with the
+ * constant-time NTCLnQ16(), so only the Steinhart-Hart polynomial itself is
+ * evaluated in float. Code-table sensors need no float at all.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "NTCSensors.h"
+
+#if USE_NTC_SENSORS
+
+// Last code of a sensor table; NTCTable.h is only included by the USE_CODE_TABLE backend
+#ifndef NTC_TABLE_MAX_CODE
+#define NTC_TABLE_MAX_CODE  ADC_FULL_SCALE
+#endif
+
+// Sensor descriptors, in conversion order
+static const NTCSensor ntcSensors[NTC_NUMBER_OF_SENSORS] = NTC_SENSORS;
+
+static unsigned int ntcSensorsOnTime;          // Last divider on-time in microseconds
+static volatile unsigned char ntcSensorsTicks;
+static volatile unsigned char ntcSensorsDue;
+
+/**
+ * @brief Supply mask of all sensors.
+ *
+ * @return OR of every sensor's power bits.
+ */
+static unsigned char NTCSensorsPowerMask(void)
+{
+    unsigned char i;
+    unsigned char mask = 0;
+
+    for (i = 0; i < NTC_NUMBER_OF_SENSORS; i++)
+    {
+        mask |= ntcSensors[i].power;
+    }
+    return mask;
+}
+
+/**
+ * @brief Interpolate a code table.
+ *
+ * @param table Array of 0.1 degC values, one every 2^stepBits codes.
+ * @param stepBits Table step as a power of two.
+ * @param ADCValue The ADC value.
+ * @return The temperature in 0.1 degC.
+ */
+static int NTCSensorTableLookup(const int *table, unsigned char stepBits, unsigned int ADCValue)
+{
+    unsigned char index;
+    unsigned int fraction;
+    int low, high;
+
+    if (ADCValue > NTC_TABLE_MAX_CODE)
+    {
+        ADCValue = NTC_TABLE_MAX_CODE;
+    }
+    index = (unsigned char)(ADCValue >> stepBits);
+    fraction = ADCValue & ((1 << stepBits) - 1);
+    low = table[index];
+    high = table[index + 1];
+
+    if (high < low)
+    {
+        return low - (int)(((unsigned int)(low - high) * fraction) >> stepBits);
+    }
+    return low + (int)(((unsigned int)(high - low) * fraction) >> stepBits);
+}
+
+/**
+ * @brief Configure the divider supply pins as outputs and switch them off.
+ */
+void NTCSensorsInit(void)
+{
+    unsigned char mask = NTCSensorsPowerMask();
+
+    NTC_SENSOR_POWER_PORT &= (unsigned char)~mask;
+    NTC_SENSOR_POWER_CONTROL &= (unsigned char)~mask;
+
+    ntcSensorsOnTime = 0;
+    ntcSensorsTicks = 0;
+    ntcSensorsDue = 0;
+}
+
+/**
+ * @brief Advance the measurement schedule by one tick.
+ */
+void NTCSensorsTick(void)
+{
+    if (++ntcSensorsTicks >= NTC_SENSOR_PERIOD_TICKS)
+    {
+        ntcSensorsTicks = 0;
+        ntcSensorsDue = 1;
+    }
+}
+
+/**
+ * @brief Read every sensor if a measurement is due.
+ *
+ * @param temperatures Array of NTC_NUMBER_OF_SENSORS results in 0.1 degC.
+ * @return 1 if the sensors were read, 0 otherwise.
+ */
+unsigned char NTCSensorsService(int *temperatures)
+{
+    if (!ntcSensorsDue)
+    {
+        return 0;
+    }
+
+    if (!NTCSensorsRead(temperatures))
+    {
+        return 0; // ADC owned by the scan or the trigger, stay due
+    }
+    ntcSensorsDue = 0;
+    return 1;
+}
+
+/**
+ * @brief Get how long the dividers are powered per measurement.
+ *
+ * @return The divider on-time in microseconds.
+ */
+unsigned int NTCSensorsOnTimeUs(void)
+{
+    return ntcSensorsOnTime;
+}
+
+/**
+ * @brief Convert one ADC value with a sensor's descriptor.
+ *
+ * @param sensor Index in NTC_SENSORS.
+ * @param ADCValue The ADC value of the sensor's channel.
+ * @return The temperature in 0.1 degC, or NTC_SENSOR_FAULT.
+ */
+int NTCSensorTemperature(unsigned char sensor, unsigned int ADCValue)
+{
+    const NTCSensor *descriptor;
+    unsigned long resistance;
+    float logResistance;
+    float temperatureK;
+
+    if (sensor >= NTC_NUMBER_OF_SENSORS)
+    {
+        return NTC_SENSOR_FAULT; // Invalid sensor
+    }
+    descriptor = &ntcSensors[sensor];
+
+    if (descriptor->method == NTC_SENSOR_CODE_TABLE)
+    {
+        return NTCSensorTableLookup(descriptor->table, descriptor->tableStepBits, ADCValue);
+    }
+
+    resistance = NTCDividerResistance(ADCValue, descriptor->topology, descriptor->resistor);
+    if (resistance == 0 || resistance == 0xFFFFFFFFUL)
+    {
+        return NTC_SENSOR_FAULT; // Shorted or open
+    }
+
+    logResistance = NTCLnQ16(resistance) * (1.0 / 65536.0);
+    temperatureK = 1.0 / (descriptor->a + descriptor->b * logResistance +
+                          descriptor->c * logResistance * logResistance * logResistance);
+
+    // Round to 0.1 degC
+    return (int)((temperatureK - 273.15) * 10.0 + ((temperatureK >= 273.15) ? 0.5 : -0.5));
+}
+
+/**
+ * @brief Read every sensor.
+ *
+ * @param temperatures Array of NTC_NUMBER_OF_SENSORS results in 0.1 degC.
+ * @return 1 if the sensors were read, 0 if the ADC is owned by an interrupt user.
+ */
+unsigned char NTCSensorsRead(int *temperatures)
+{
+    unsigned int codes[NTC_NUMBER_OF_SENSORS];
+    unsigned char mask = NTCSensorsPowerMask();
+    unsigned char interrupts = _emi;
+    unsigned int steps;
+    unsigned long cycles = (unsigned long)NTC_SENSOR_SETTLE_STEPS * NTC_SENSOR_SETTLE_STEP_CYCLES;
+    unsigned long onTime;
+    unsigned char i;
+
+    if (ADCInterruptBusy())
+    {
+        return 0; // The scan sequencer or the timer trigger owns the ADC
+    }
+
+#if USE_ADC_BURST_MODE
+    ADCBurstBegin(); // Power the converter up before the dividers
+#endif
+
+    _emi = 0; // Interrupts may write the same port
+    NTC_SENSOR_POWER_PORT |= mask;
+    _emi = interrupts;
+
+    // Interrupts only make the settling longer, so they may run here
+    for (steps = NTC_SENSOR_SETTLE_STEPS; steps; steps--)
+    {
+        GCC_DELAY(NTC_SENSOR_SETTLE_STEP_CYCLES); // Let every divider settle once
+    }
+
+    // Back-to-back conversions, then off, with nothing in between
+    _emi = 0;
+    for (i = 0; i < NTC_NUMBER_OF_SENSORS; i++)
+    {
+        codes[i] = ReadADC(ntcSensors[i].channel);
+    }
+    NTC_SENSOR_POWER_PORT &= (unsigned char)~mask;
+    _emi = interrupts;
+
+    for (i = 0; i < NTC_NUMBER_OF_SENSORS; i++)
+    {
+        cycles += ADCConversionCycles(ntcSensors[i].channel);
+    }
+    onTime = (cycles * 1000UL) / (NTC_INSTRUCTION_HZ / 1000UL);
+    ntcSensorsOnTime = (onTime > 0xFFFF) ? 0xFFFF : (unsigned int)onTime;
+
+#if USE_ADC_BURST_MODE
+    ADCBurstEnd();
+#endif
+
+    // Convert after the dividers are off so they are powered only for the conversions
+    for (i = 0; i < NTC_NUMBER_OF_SENSORS; i++)
+    {
+        temperatures[i] = NTCSensorTemperature(i, codes[i]);
+    }
+    return 1;
+}
+
+#endif
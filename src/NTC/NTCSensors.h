@@ -0,0 +1,168 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file NTCSensors.h
+ * @brief Header file for the multi-sensor NTC manager.
+ *
+ * Every thermistor on the board is described by one ROM descriptor: ADC
+ * channel, divider topology and resistor, power pin mask and either its own
+ * Steinhart-Hart coefficients or a code table in the NTCTable.h format.
+ * NTCSensorsRead() powers every divider once, converts all channels
+ * back-to-back in ADC burst mode and returns all temperatures in 0.1 degC.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef NTC_SENSORS_H
+#define NTC_SENSORS_H
+
+#include "NTC.h"
+#include "ADC.h"
+#include "RCC.h"
+
+// Enable or Disable the multi-sensor manager
+#define USE_NTC_SENSORS           Enable
+
+// Port that drives the divider supplies; each sensor owns a bit mask of it
+#define NTC_SENSOR_POWER_PORT     _pa
+#define NTC_SENSOR_POWER_CONTROL  _pac
+
+// RC settling after the dividers are powered: the filter capacitor at the ADC
+// input charges through at most the largest fixed resistor (R || Rntc).
+// 9 time constants settle to 12 bits (ln(4096) = 8.3).
+#define NTC_SENSOR_FILTER_NF      10      /**< Filter capacitor at the ADC input, nF */
+#define NTC_SENSOR_SOURCE_OHMS    10000UL /**< Largest fixed divider resistor, ohms */
+#define NTC_SENSOR_SETTLE_TAU     9
+
+// Number of NTCSensorsTick() calls between two measurements
+#define NTC_SENSOR_PERIOD_TICKS   100
+
+// Settling time in microseconds and in instruction cycles (fSYS / 4)
+#define NTC_SENSOR_SETTLE_US      ((NTC_SENSOR_SETTLE_TAU * NTC_SENSOR_SOURCE_OHMS * NTC_SENSOR_FILTER_NF + 999) / 1000)
+#define NTC_INSTRUCTION_HZ        (SYSTEM_CLOCK_HZ / 4)
+#define NTC_SENSOR_SETTLE_CYCLES  ((NTC_SENSOR_SETTLE_US * (NTC_INSTRUCTION_HZ / 1000UL) + 999) / 1000)
+
+// The settling delay runs in steps of GCC_DELAY(NTC_SENSOR_SETTLE_STEP_CYCLES)
+#define NTC_SENSOR_SETTLE_STEP_CYCLES  20
+#define NTC_SENSOR_SETTLE_STEPS   ((NTC_SENSOR_SETTLE_CYCLES + NTC_SENSOR_SETTLE_STEP_CYCLES - 1) / NTC_SENSOR_SETTLE_STEP_CYCLES)
+
+// Conversion methods
+#define NTC_SENSOR_STEINHART      0 /**< Per-sensor A/B/C coefficients (ohms) */
+#define NTC_SENSOR_CODE_TABLE     1 /**< Per-sensor code table in 0.1 degC */
+
+// Returned for an open or shorted sensor
+#define NTC_SENSOR_FAULT          (-32768)
+
+/**
+ * @brief Descriptor of a sensor using Steinhart-Hart coefficients.
+ *
+ * @param channel ADC channel (AN0..AN3).
+ * @param topology NTC_IS_PULLDOWN or NTC_IS_PULLUP.
+ * @param resistor Fixed divider resistor in ohms.
+ * @param power Bit mask on NTC_SENSOR_POWER_PORT, 0 if always powered.
+ */
+#define NTC_SENSOR_STEINHART_HART(channel, topology, resistor, power, a, b, c) \
+    { (channel), (topology), (power), NTC_SENSOR_STEINHART, 0, (resistor), (a), (b), (c), 0 }
+
+/**
+ * @brief Descriptor of a sensor using a code table.
+ *
+ * @param table Array of 0.1 degC values, one every 2^stepBits codes up to code 4096.
+ * @param stepBits Table step as a power of two (4..7).
+ */
+#define NTC_SENSOR_TABLE(channel, topology, resistor, power, table, stepBits) \
+    { (channel), (topology), (power), NTC_SENSOR_CODE_TABLE, (stepBits), (resistor), 0, 0, 0, (table) }
+
+// Sensors on the board, converted in this order
+#define NTC_SENSORS { \
+    NTC_SENSOR_STEINHART_HART(AN0, NTC_IS_PULLDOWN, 10000UL, 0x80, 0.001277368779, 0.0002082232310, 0.0000002032989311), \
+    NTC_SENSOR_STEINHART_HART(AN1, NTC_IS_PULLDOWN, 10000UL, 0x80, 0.001277368779, 0.0002082232310, 0.0000002032989311) \
+}
+#define NTC_NUMBER_OF_SENSORS     2
+
+/** @brief One thermistor and its divider. */
+typedef struct
+{
+    unsigned char channel;        /**< ADC channel */
+    unsigned char topology;       /**< NTC_IS_PULLDOWN or NTC_IS_PULLUP */
+    unsigned char power;          /**< Supply bit mask on NTC_SENSOR_POWER_PORT */
+    unsigned char method;         /**< NTC_SENSOR_STEINHART or NTC_SENSOR_CODE_TABLE */
+    unsigned char tableStepBits;  /**< Code table step as a power of two */
+    unsigned long resistor;       /**< Fixed divider resistor in ohms */
+    float a, b, c;                /**< Steinhart-Hart coefficients */
+    const int *table;             /**< Code table in 0.1 degC */
+} NTCSensor;
+
+#if USE_NTC_SENSORS
+
+/**
+ * @brief Configure the divider supply pins as outputs and switch them off.
+ */
+void NTCSensorsInit(void);
+
+/**
+ * @brief Read every sensor.
+ *
+ * Interrupts are masked only for the port writes and the back-to-back burst
+ * conversions. They keep running during the RC settling delay, which an
+ * interrupt can only make longer, so the UART and timer interrupts are held
+ * off for the conversions alone. Nothing is powered or converted while the
+ * ADC scan sequencer or the timer trigger owns the ADC (ADCInterruptBusy()).
+ *
+ * @param temperatures Array of NTC_NUMBER_OF_SENSORS results in 0.1 degC
+ *                     (NTC_SENSOR_FAULT for an open or shorted sensor),
+ *                     left untouched when 0 is returned.
+ * @return 1 if the sensors were read, 0 if the ADC is owned by an interrupt user.
+ */
+unsigned char NTCSensorsRead(int *temperatures);
+
+/**
+ * @brief Advance the measurement schedule by one tick.
+ *
+ * Safe to call from a timer interrupt; it only marks a measurement as due.
+ */
+void NTCSensorsTick(void);
+
+/**
+ * @brief Read every sensor if a measurement is due.
+ *
+ * Call from the main loop. While the ADC is owned by the scan sequencer or
+ * the timer trigger the measurement stays due.
+ *
+ * @param temperatures Array of NTC_NUMBER_OF_SENSORS results in 0.1 degC.
+ * @return 1 if the sensors were read, 0 otherwise.
+ */
+unsigned char NTCSensorsService(int *temperatures);
+
+/**
+ * @brief Get how long the dividers are powered per measurement.
+ *
+ * Counted in instruction cycles: the settling steps the last read ran plus
+ * each channel's ADCConversionCycles(). Interrupts serviced during the
+ * settling delay are not included, so this is the shortest the dividers
+ * were on; the conversions themselves run with interrupts masked.
+ *
+ * @return The divider on-time of the last NTCSensorsRead() in microseconds,
+ *         0 before the first one.
+ */
+unsigned int NTCSensorsOnTimeUs(void);
+
+/**
+ * @brief Convert one ADC value with a sensor's descriptor.
+ *
+ * @param sensor Index in NTC_SENSORS.
+ * @param ADCValue The ADC value of the sensor's channel.
+ * @return The temperature in 0.1 degC, or NTC_SENSOR_FAULT (also for an
+ *         index at or past NTC_NUMBER_OF_SENSORS).
+ */
+int NTCSensorTemperature(unsigned char sensor, unsigned int ADCValue);
+
+#endif
+
+#endif // NTC_SENSORS_H
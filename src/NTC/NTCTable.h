@@ -0,0 +1,110 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file NTCTable.h
+ * @brief ADC code to temperature table for the USE_CODE_TABLE backend.
+ *
+ * Temperatures are in 0.1 degC, one entry every 2^NTC_TABLE_STEP_BITS codes
+ * from code 0 up to and including code 4096, clamped to
+ * NTC_TABLE_MIN..NTC_TABLE_MAX. Do not edit; regenerate with
+ * tools/NTCTableGen after changing the coefficients or the divider in NTC.h.
+ *
+ * Generated from:
+ *   A = 0.001277368779, B = 0.000208223231, C = 2.032989311e-07
+ *   Fixed resistor = 10000 ohm, NTC_IS_PULLDOWN, full scale = 4095
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef NTC_TABLE_H
+#define NTC_TABLE_H
+
+// Divider the table was generated for, checked against NTC.h
+#define NTC_TABLE_FIXED_RESISTOR  10
+#define NTC_TABLE_TOPOLOGY        NTC_IS_PULLDOWN
+
+// Clamp limits in 0.1 degC
+#define NTC_TABLE_MIN  (-400)
+#define NTC_TABLE_MAX  1250
+
+// Highest ADC code, ADCNumerOfBits rounded up to whole bits
+#define NTC_TABLE_MAX_CODE  4095
+
+// Step used unless NTC.h or the build sets NTC_TABLE_STEP_BITS
+#ifndef NTC_TABLE_STEP_BITS
+#define NTC_TABLE_STEP_BITS  6
+#endif
+
+#if NTC_TABLE_STEP_BITS == 4
+#define NTC_TABLE_SIZE       257
+#define NTC_TABLE_MAX_DELTA  44
+static const int ntcCodeTable[NTC_TABLE_SIZE] = {
+     1250,  1250,  1250,  1250,  1250,  1250,  1250,  1250,  1238,  1194,  1156,  1122,
+     1091,  1062,  1036,  1012,   990,   969,   949,   931,   913,   897,   881,   866,
+      852,   838,   825,   812,   800,   788,   777,   766,   755,   745,   735,   725,
+      716,   707,   698,   689,   681,   672,   664,   656,   649,   641,   634,   626,
+      619,   612,   605,   599,   592,   586,   579,   573,   567,   561,   555,   549,
+      543,   537,   532,   526,   521,   515,   510,   504,   499,   494,   489,   484,
+      479,   474,   469,   464,   459,   455,   450,   445,   441,   436,   431,   427,
+      422,   418,   414,   409,   405,   401,   396,   392,   388,   384,   380,   376,
+      371,   367,   363,   359,   355,   351,   347,   343,   340,   336,   332,   328,
+      324,   320,   316,   313,   309,   305,   301,   298,   294,   290,   286,   283,
+      279,   275,   272,   268,   264,   261,   257,   254,   250,   246,   243,   239,
+      235,   232,   228,   225,   221,   218,   214,   210,   207,   203,   200,   196,
+      193,   189,   185,   182,   178,   175,   171,   168,   164,   160,   157,   153,
+      150,   146,   142,   139,   135,   131,   128,   124,   120,   117,   113,   109,
+      106,   102,    98,    94,    91,    87,    83,    79,    75,    71,    68,    64,
+       60,    56,    52,    48,    44,    40,    36,    32,    27,    23,    19,    15,
+       11,     6,     2,    -2,    -7,   -11,   -16,   -20,   -25,   -30,   -34,   -39,
+      -44,   -49,   -54,   -59,   -64,   -69,   -74,   -79,   -84,   -90,   -95,  -101,
+     -107,  -112,  -118,  -124,  -131,  -137,  -143,  -150,  -156,  -163,  -170,  -177,
+     -185,  -192,  -200,  -208,  -216,  -225,  -234,  -243,  -252,  -262,  -273,  -284,
+     -295,  -307,  -320,  -333,  -348,  -363,  -380,  -398,  -400,  -400,  -400,  -400,
+     -400,  -400,  -400,  -400,  -400
+};
+#elif NTC_TABLE_STEP_BITS == 5
+#define NTC_TABLE_SIZE       129
+#define NTC_TABLE_MAX_DELTA  82
+static const int ntcCodeTable[NTC_TABLE_SIZE] = {
+     1250,  1250,  1250,  1250,  1238,  1156,  1091,  1036,   990,   949,   913,   881,
+      852,   825,   800,   777,   755,   735,   716,   698,   681,   664,   649,   634,
+      619,   605,   592,   579,   567,   555,   543,   532,   521,   510,   499,   489,
+      479,   469,   459,   450,   441,   431,   422,   414,   405,   396,   388,   380,
+      371,   363,   355,   347,   340,   332,   324,   316,   309,   301,   294,   286,
+      279,   272,   264,   257,   250,   243,   235,   228,   221,   214,   207,   200,
+      193,   185,   178,   171,   164,   157,   150,   142,   135,   128,   120,   113,
+      106,    98,    91,    83,    75,    68,    60,    52,    44,    36,    27,    19,
+       11,     2,    -7,   -16,   -25,   -34,   -44,   -54,   -64,   -74,   -84,   -95,
+     -107,  -118,  -131,  -143,  -156,  -170,  -185,  -200,  -216,  -234,  -252,  -273,
+     -295,  -320,  -348,  -380,  -400,  -400,  -400,  -400,  -400
+};
+#elif NTC_TABLE_STEP_BITS == 6
+#define NTC_TABLE_SIZE       65
+#define NTC_TABLE_MAX_DELTA  147
+static const int ntcCodeTable[NTC_TABLE_SIZE] = {
+     1250,  1250,  1238,  1091,   990,   913,   852,   800,   755,   716,   681,   649,
+      619,   592,   567,   543,   521,   499,   479,   459,   441,   422,   405,   388,
+      371,   355,   340,   324,   309,   294,   279,   264,   250,   235,   221,   207,
+      193,   178,   164,   150,   135,   120,   106,    91,    75,    60,    44,    27,
+       11,    -7,   -25,   -44,   -64,   -84,  -107,  -131,  -156,  -185,  -216,  -252,
+     -295,  -348,  -400,  -400,  -400
+};
+#elif NTC_TABLE_STEP_BITS == 7
+#define NTC_TABLE_SIZE       33
+#define NTC_TABLE_MAX_DELTA  248
+static const int ntcCodeTable[NTC_TABLE_SIZE] = {
+     1250,  1238,   990,   852,   755,   681,   619,   567,   521,   479,   441,   405,
+      371,   340,   309,   279,   250,   221,   193,   164,   135,   106,    75,    44,
+       11,   -25,   -64,  -107,  -156,  -216,  -295,  -400,  -400
+};
+#else
+#error "NTCTable.h has no table for this NTC_TABLE_STEP_BITS (4..7)"
+#endif
+
+#endif // NTC_TABLE_H
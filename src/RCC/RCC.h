@@ -58,6 +58,17 @@
 #define CONFIG_CLOCK_OVER    INTERNAL_8_MHZ  // Default clock setting
 #define CONFIG_WDT           WDT_TIMEOUT_4_SEC  // Default WDT setting
 
+// Clock frequencies in Hz that follow from the configuration above
+// RCC_Init() runs the system clock undivided, so fSYS = fH = HIRC
+#if CONFIG_CLOCK_OVER == INTERNAL_8_MHZ
+    #define SYSTEM_CLOCK_HZ   8000000UL
+#elif CONFIG_CLOCK_OVER == INTERNAL_4_MHZ
+    #define SYSTEM_CLOCK_HZ   4000000UL
+#else
+    #define SYSTEM_CLOCK_HZ   2000000UL
+#endif
+#define SUB_CLOCK_HZ          32000UL  // fSUB from LIRC
+
 // Function prototypes
 void RCC_Init(void);
 void Enter_Sleep_Mode(void);
@@ -0,0 +1,135 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file SupplyMonitor.c
+ * @brief Implementation of the VBGREF-based supply voltage monitor.
+ *
+ * The divisions are done once per measurement in SupplyMonitorUpdate():
+ *   vdd     = VBG * FS / code              (millivolts)
+ *   toMv    = vdd * 65536 / FS             (mV = code * toMv >> 16)
+ *   toCode  = FS * 65536 / vdd             (code = mV * toCode >> 16)
+ * with FS = ADC_FULL_SCALE (4095).
+ * Both products stay below 2^32 for 12-bit codes and supplies up to 5.5 V.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "SupplyMonitor.h"
+
+#if USE_SUPPLY_MONITOR
+
+static unsigned int supplyMillivolts;  // Cached VDD
+static unsigned long supplyToMillivolts; // Q16 factor, code -> mV
+static unsigned long supplyToCode;       // Q16 factor, mV -> code
+
+static volatile unsigned char supplyTicks;
+static volatile unsigned char supplyDue;
+
+/**
+ * @brief Recompute the cached factors for a supply voltage.
+ *
+ * @param millivolts VDD in millivolts.
+ */
+static void SupplyMonitorSetVDD(unsigned int millivolts)
+{
+    supplyMillivolts = millivolts;
+    supplyToMillivolts = ((unsigned long)millivolts << 16) / SUPPLY_ADC_FULL_SCALE;
+    supplyToCode = (SUPPLY_ADC_FULL_SCALE << 16) / millivolts;
+}
+
+/**
+ * @brief Initialize the monitor and take the first VBGREF measurement.
+ */
+void SupplyMonitorInit(void)
+{
+    SupplyMonitorSetVDD(SUPPLY_DEFAULT_MILLIVOLTS);
+    supplyTicks = 0;
+    supplyDue = 1;
+    SupplyMonitorService();
+}
+
+/**
+ * @brief Advance the measurement schedule by one tick.
+ */
+void SupplyMonitorTick(void)
+{
+    if (++supplyTicks >= SUPPLY_UPDATE_TICKS)
+    {
+        supplyTicks = 0;
+        supplyDue = 1;
+    }
+}
+
+/**
+ * @brief Measure VBGREF if a measurement is due and the ADC is free.
+ *
+ * @return 1 if the cached values were refreshed, 0 otherwise.
+ */
+unsigned char SupplyMonitorService(void)
+{
+    if (!supplyDue || ADCInterruptBusy())
+    {
+        return 0; // Not due, or the scan or the trigger owns the ADC and it stays due
+    }
+    supplyDue = 0;
+
+    return SupplyMonitorUpdate(ReadADC_VBGREF());
+}
+
+/**
+ * @brief Refresh the cached values from a VBGREF conversion result.
+ *
+ * @param vbgCode 12-bit VBGREF conversion result.
+ * @return 1 if the cached values were refreshed, 0 if the code was rejected.
+ */
+unsigned char SupplyMonitorUpdate(unsigned int vbgCode)
+{
+    if ((vbgCode < SUPPLY_MIN_VBG_CODE) || (vbgCode > SUPPLY_MAX_VBG_CODE))
+    {
+        return 0; // Supply out of range or bandgap not settled
+    }
+
+    // Round to the nearest millivolt
+    SupplyMonitorSetVDD((unsigned int)((SUPPLY_VBG_MILLIVOLTS * SUPPLY_ADC_FULL_SCALE + (vbgCode >> 1)) / vbgCode));
+    return 1;
+}
+
+/**
+ * @brief Get the cached supply voltage.
+ *
+ * @return VDD in millivolts.
+ */
+unsigned int SupplyMonitorVDD(void)
+{
+    return supplyMillivolts;
+}
+
+/**
+ * @brief Convert a 12-bit ADC code to millivolts at the cached VDD.
+ *
+ * @param code ADC conversion result.
+ * @return Input voltage in millivolts.
+ */
+unsigned int SupplyMonitorCodeToMillivolts(unsigned int code)
+{
+    return (unsigned int)((code * supplyToMillivolts + 0x8000UL) >> 16);
+}
+
+/**
+ * @brief Convert millivolts to the 12-bit ADC code expected at the cached VDD.
+ *
+ * @param millivolts Input voltage in millivolts (at most VDD).
+ * @return Expected ADC code.
+ */
+unsigned int SupplyMonitorMillivoltsToCode(unsigned int millivolts)
+{
+    return (unsigned int)((millivolts * supplyToCode + 0x8000UL) >> 16);
+}
+
+#endif
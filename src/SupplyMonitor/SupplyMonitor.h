@@ -0,0 +1,119 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file SupplyMonitor.h
+ * @brief Header file for the VBGREF-based supply voltage monitor.
+ *
+ * The ADC reference is VDD, so the bandgap reading gives VDD as
+ * VDD = VBG * full scale / code. The monitor samples VBGREF on a slow
+ * schedule and caches VDD in millivolts together with two Q16 factors,
+ * so converting between ADC codes and millivolts is a multiply and a
+ * shift. Only the schedule update divides; the conversion helpers never
+ * start a conversion.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef SUPPLY_MONITOR_H
+#define SUPPLY_MONITOR_H
+
+#include "ADC.h"
+
+// Enable or Disable the supply monitor
+#define USE_SUPPLY_MONITOR          Enable
+
+// Bandgap reference voltage in millivolts (calibrate per lot if needed)
+#define SUPPLY_VBG_MILLIVOLTS       1040UL
+
+// ADC full-scale code, shared with NTC.h through ADC.h
+#define SUPPLY_ADC_FULL_SCALE       ((unsigned long)ADC_FULL_SCALE)
+
+// Supply range accepted from a measurement, in millivolts
+#define SUPPLY_MIN_MILLIVOLTS       1800UL
+#define SUPPLY_MAX_MILLIVOLTS       5500UL
+
+// VDD assumed before the first measurement, in millivolts
+#define SUPPLY_DEFAULT_MILLIVOLTS   3300UL
+
+// Number of SupplyMonitorTick() calls between two VBGREF measurements
+#define SUPPLY_UPDATE_TICKS         64
+
+// Valid VBGREF codes for the accepted supply range
+#define SUPPLY_MIN_VBG_CODE  ((SUPPLY_VBG_MILLIVOLTS * SUPPLY_ADC_FULL_SCALE) / SUPPLY_MAX_MILLIVOLTS)
+#define SUPPLY_MAX_VBG_CODE  ((SUPPLY_VBG_MILLIVOLTS * SUPPLY_ADC_FULL_SCALE) / SUPPLY_MIN_MILLIVOLTS)
+
+#if USE_SUPPLY_MONITOR
+
+#if !USE_ADC_VBGREF
+#error "The supply monitor needs USE_ADC_VBGREF enabled"
+#endif
+
+/**
+ * @brief Initialize the monitor and take the first VBGREF measurement.
+ *
+ * ADCInit() must be called first.
+ */
+void SupplyMonitorInit(void);
+
+/**
+ * @brief Advance the measurement schedule by one tick.
+ *
+ * Safe to call from a timer interrupt; it only marks a measurement as due.
+ */
+void SupplyMonitorTick(void);
+
+/**
+ * @brief Measure VBGREF if a measurement is due.
+ *
+ * Call from the main loop. While the ADC scan sequencer or the timer trigger
+ * owns the ADC (ADCInterruptBusy()) no conversion is started and the
+ * measurement stays due; feed SupplyMonitorUpdate() their VBGREF result instead.
+ *
+ * @return 1 if the cached values were refreshed, 0 otherwise.
+ */
+unsigned char SupplyMonitorService(void);
+
+/**
+ * @brief Refresh the cached values from a VBGREF conversion result.
+ *
+ * Main-context only. Out-of-range codes are ignored.
+ *
+ * @param vbgCode 12-bit VBGREF conversion result.
+ * @return 1 if the cached values were refreshed, 0 if the code was rejected.
+ */
+unsigned char SupplyMonitorUpdate(unsigned int vbgCode);
+
+/**
+ * @brief Get the cached supply voltage.
+ *
+ * @return VDD in millivolts.
+ */
+unsigned int SupplyMonitorVDD(void);
+
+/**
+ * @brief Convert a 12-bit ADC code to millivolts at the cached VDD.
+ *
+ * @param code ADC conversion result.
+ * @return Input voltage in millivolts.
+ */
+unsigned int SupplyMonitorCodeToMillivolts(unsigned int code);
+
+/**
+ * @brief Convert millivolts to the 12-bit ADC code expected at the cached VDD.
+ *
+ * Useful for turning fixed thresholds into codes once per supply update.
+ *
+ * @param millivolts Input voltage in millivolts (at most VDD).
+ * @return Expected ADC code.
+ */
+unsigned int SupplyMonitorMillivoltsToCode(unsigned int millivolts);
+
+#endif
+
+#endif // SUPPLY_MONITOR_H
@@ -17,6 +17,7 @@
 #define PTIMER_H
 
 #include <Main.h>
+#include "RCC.h"
 
 /** @brief PTM Counter Clock Selection
  * This section defines the clock sources for the PTM counter.
@@ -33,6 +34,21 @@
 #define PTIMER_CLOCK    PT_SYS
 //=========================================================================
 
+/** @brief PTM counter clock frequency in Hz for the selected PTIMER_CLOCK
+ * Not defined for the external PTCK clock, which has no known frequency.
+ */
+#if PTIMER_CLOCK == PT_SYS_DIVIDE_4
+    #define PTM_CLOCK_HZ    (SYSTEM_CLOCK_HZ / 4)
+#elif PTIMER_CLOCK == PT_SYS
+    #define PTM_CLOCK_HZ    SYSTEM_CLOCK_HZ
+#elif PTIMER_CLOCK == PT_H_DIVIDE_16
+    #define PTM_CLOCK_HZ    (SYSTEM_CLOCK_HZ / 16)
+#elif PTIMER_CLOCK == PT_H_DIVIDE_64
+    #define PTM_CLOCK_HZ    (SYSTEM_CLOCK_HZ / 64)
+#elif (PTIMER_CLOCK == PT_SUB1) || (PTIMER_CLOCK == PT_SUB2)
+    #define PTM_CLOCK_HZ    SUB_CLOCK_HZ
+#endif
+
 /** @brief PTM Operating Modes
  * This section defines the operating modes for the PTM.
  */
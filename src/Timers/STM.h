@@ -17,6 +17,7 @@
 #define STIMER_H
 
 #include <Main.h>  // Assuming this includes necessary main header file
+#include "RCC.h"
 
 /** @brief STM Counter Clock Selection
  * This section defines the clock sources for the STM counter.
@@ -33,6 +34,21 @@
 #define STIMER_CLOCK    ST_FSYS
 //=========================================================================
 
+/** @brief STM counter clock frequency in Hz for the selected STIMER_CLOCK
+ * Not defined for the external STCK clock, which has no known frequency.
+ */
+#if STIMER_CLOCK == ST_FSYS_DIVIDE_4
+    #define STM_CLOCK_HZ    (SYSTEM_CLOCK_HZ / 4)
+#elif STIMER_CLOCK == ST_FSYS
+    #define STM_CLOCK_HZ    SYSTEM_CLOCK_HZ
+#elif STIMER_CLOCK == ST_FH_DIVIDE_16
+    #define STM_CLOCK_HZ    (SYSTEM_CLOCK_HZ / 16)
+#elif STIMER_CLOCK == ST_FH_DIVIDE_64
+    #define STM_CLOCK_HZ    (SYSTEM_CLOCK_HZ / 64)
+#elif (STIMER_CLOCK == ST_FSUB1) || (STIMER_CLOCK == ST_FSUB2)
+    #define STM_CLOCK_HZ    SUB_CLOCK_HZ
+#endif
+
 /** @brief STM Comparator P Match Period
  * This section defines the various comparator match periods for the STM.
  */
@@ -16,17 +16,42 @@
 #include "UART.h"
 #include <BA45F5240.h>
 
-/** @brief Initializes the UART with a specified baud rate.
- * @param baudrate The baud rate for UART communication.
+#if USE_UART_RX_BUFFER
+static volatile unsigned char uartRxBuffer[UART_RX_BUFFER_SIZE + UART_RX_MIRROR_SIZE]; // Ring, then the mirror
+static volatile unsigned char uartRxHead; // Written by the ISR only
+static volatile unsigned char uartRxTail; // Written by main code only
+static volatile unsigned int uartRxOverflows; // Written by the ISR only
+#endif
+
+#if USE_UART_TX_BUFFER
+static volatile unsigned char uartTxBuffer[UART_TX_BUFFER_SIZE];
+static volatile unsigned char uartTxHead; // Written by main code only
+static volatile unsigned char uartTxTail; // Written by the ISR only
+#endif
+
+#if USE_UART_ERROR_STATS
+static volatile unsigned int uartErrorCounts[UART_ERROR_RX_OVERFLOW]; // Hardware flags; the ring counts its own overflows
+static volatile unsigned char uartErrorFlags; // Sticky UART_STATUS_* bits: set by the receive path, cleared one bit at a time
+#endif
+
+#if USE_UART_MULTIDROP
+static unsigned char uartNodeAddress;
+static volatile unsigned char uartAddressed; // Written by the ISR, cleared with interrupts masked
+#endif
+
+/** @brief Initializes the UART at UART_BAUD_RATE.
  *
- * This function configures the UART pins, sets the UART mode, and calculates the
- * baud rate register values based on the provided baud rate.
+ * This function configures the UART pins, sets the UART mode, and writes the
+ * baud rate registers with the constants solved from SYSTEM_CLOCK_HZ.
  */
-void UART_Init(unsigned int baudrate) {
+void UART_Init(void) {
+#if USE_UART_ERROR_STATS
+    unsigned char error;
+#endif
+
     _umd = 1; // UMD: UART mode selection bit, 1: UART mode
     _ubrgh = SPEED_BAUDRATE; // Set baud rate speed
-    unsigned int ubrr = (F_CPU / (CONSTANT_NUMBER * baudrate)) - 1.0; // Calculate baud rate register value
-    _ubrg = ubrr & 0xFF; // Set baud rate register
+    _ubrg = UART_UBRG; // Set baud rate register
     _uren = 1; // Enable UART (UREN)
     _ubno = DATA_TRANSFER; // Set data transfer bit selection
     _upren = PARITY; // Set parity enable/disable
@@ -37,6 +62,29 @@ void UART_Init(unsigned int baudrate) {
     _utiie = TRANSMITTER_IDLE_INTERRUPT; // Enable/disable transmitter idle interrupt
     _uteie = TRANSMITTER_EMPTY_INTERRUPT; // Enable/disable transmitter empty interrupt
     _urie = RECEIVER_INTERRUPT; // Enable/disable receiver interrupt
+
+#if USE_UART_RX_BUFFER
+    uartRxHead = 0;
+    uartRxTail = 0;
+    uartRxOverflows = 0;
+#endif
+#if USE_UART_TX_BUFFER
+    _uteie = 0; // Switched on by UART_Write() while there is data to send
+    uartTxHead = 0;
+    uartTxTail = 0;
+#endif
+#if USE_UART_ERROR_STATS
+    for (error = 0; error < UART_ERROR_RX_OVERFLOW; error++) {
+        uartErrorCounts[error] = 0;
+    }
+    uartErrorFlags = 0;
+#endif
+#if USE_UART_MULTIDROP
+    uartNodeAddress = UART_NODE_ADDRESS;
+    uartAddressed = 0;
+    _utx8 = 0; // Data words unless UART_TransmitAddress() is sending
+    _uadden = 1; // Only address words raise URXIF until this node is selected
+#endif
 }
 
 /** @brief Transmits a single character via UART.
@@ -46,77 +94,69 @@ void UART_Init(unsigned int baudrate) {
  * through the UART.
  */
 void UART_Transmit(char data) {
+#if USE_UART_TX_BUFFER
+    // Queue behind UART_Write() data so the byte order is kept
+    while (!UART_Write((const unsigned char *)&data, 1)) {
+        if (!_emi) UART_TxISR(); // Nothing drains the ring with interrupts masked
+    }
+#else
     // Wait for empty transmit buffer
     while (!(_utxif)); // Wait until UTXIF is set
     _utxr_rxr = data; // Put data into buffer, sends the data
+#endif
 }
 
 /** @brief Receives a single character via UART.
- * @return The received character, or an error code in case of an error.
+ * @return The received character.
  *
- * This function waits until data is received and checks for errors such as
- * parity, overrun, or framing errors before returning the received data.
+ * This function waits until data is received and returns it. Parity,
+ * overrun, framing and noise errors are counted (USE_UART_ERROR_STATS)
+ * instead of being returned in place of the data.
  */
 char UART_Receive(void) {
-    _acc = 0; // Clear accumulator
-    // Wait for data to be received
-    while (!((_urxif) && (_utidle))); // Wait until URXIF and UTIDLE are set
-
-    _acc = _utxr_rxr; // Get received data from buffer
-    _urxif = 0; // Clear the receive flag (URXIF)
+#if USE_UART_RX_BUFFER
+    unsigned char data;
 
-#if CHECK_RECEIVER_ERROR
-    // Check for parity error
-    if (_uperr) {
-        _uperr = 0; // Clear parity error flag
-        return UART_PARITY_ERROR; // Return parity error code
-    }
-    // Check for overrun error
-    if (_uoerr) {
-        _uoerr = 0; // Clear overrun error flag
-        return UART_OVERRUN_ERROR; // Return overrun error code
-    }
-    // Check for framing error
-    if (_uferr) {
-        _uferr = 0; // Clear framing error flag
-        return UART_FRAMING_ERROR; // Return framing error code
+    // Wait until the ISR has buffered a byte
+    while (!UART_Read(&data, 1)) {
+        if (!_emi) UART_RxISR(); // Nothing fills the ring with interrupts masked
     }
+    return data;
+#else
+    // Wait for data to be received (UTIDLE is the transmitter, not the receiver)
+    while (!_urxif);
+
+#if USE_UART_ERROR_STATS
+    UART_RxErrors(); // The flags belong to this word; reading the data clears them
 #endif
+    _acc = _utxr_rxr; // Get received data from buffer
+    _urxif = 0; // Clear the receive flag (URXIF)
 
     return _acc; // Return received data
+#endif
 }
 
 /** @brief Receives a single character via UART in a non-blocking manner.
- * @return The received character if available; otherwise, an error code.
+ * @param data Where to store the received character; left unchanged if none.
+ * @return 1 if a character was received, 0 if none was available.
  *
  * This function checks if data is available and then receives a single character via UART.
  * It is non-blocking and suitable for use in interrupt service routines.
  */
-char UART_ReceiveNonBlocking(void) {
-    _acc = 0; // Clear accumulator
-    if (_urxif) { // Check if data has been received
-        _acc = _utxr_rxr; // Get received data from buffer
-    }
-
-#if CHECK_RECEIVER_ERROR
-    // Check for parity error
-    if (_uperr) {
-        _uperr = 0; // Clear parity error flag
-        return UART_PARITY_ERROR; // Return parity error code
-    }
-    // Check for overrun error
-    if (_uoerr) {
-        _uoerr = 0; // Clear overrun error flag
-        return UART_OVERRUN_ERROR; // Return overrun error code
-    }
-    // Check for framing error
-    if (_uferr) {
-        _uferr = 0; // Clear framing error flag
-        return UART_FRAMING_ERROR; // Return framing error code
+unsigned char UART_ReceiveNonBlocking(unsigned char *data) {
+#if USE_UART_RX_BUFFER
+    return UART_Read(data, 1); // 1 if a byte was taken from the buffer, 0 if it is empty
+#else
+    if (!_urxif) { // Check if data has been received
+        return 0;
     }
+#if USE_UART_ERROR_STATS
+    UART_RxErrors(); // The flags belong to this word; reading the data clears them
+#endif
+    *data = _utxr_rxr; // Get received data from buffer
+    _urxif = 0; // Clear the receive flag, so the same word is not read twice
+    return 1;
 #endif
-
-    return _acc; // Return received data or 0 if no data
 }
 
 /** @brief Enables UART interrupts for receiving and transmitting.
@@ -135,3 +175,276 @@ void UART_EnableInterrupts(void) {
 void UART_DisableInterrupts(void) {
     _uucr2 &= ~(_urie | _utiie | _uteie); // Disable all UART interrupts
 }
+
+#if USE_UART_RX_BUFFER
+/** @brief Moves received bytes into the receive ring buffer.
+ *
+ * Reading the data register clears URXIF. A byte that does not fit is read
+ * anyway, so the receiver keeps running, and counted as an overflow.
+ * With USE_UART_MULTIDROP, address words select or deselect this node and
+ * are not stored.
+ */
+void UART_RxISR(void) {
+    unsigned char head, next, data;
+
+    while (_urxif) {
+#if USE_UART_ERROR_STATS
+        UART_RxErrors(); // Before the data register read clears the flags
+#endif
+#if USE_UART_MULTIDROP
+        if (_urx8) { // Address word; RX8 has to be read before the data register
+            data = _utxr_rxr;
+            uartAddressed = (data == uartNodeAddress || data == UART_BROADCAST_ADDRESS);
+            _uadden = !uartAddressed; // Drop the data words of other nodes in hardware
+            continue;
+        }
+#endif
+        head = uartRxHead;
+        next = (head + 1) & (UART_RX_BUFFER_SIZE - 1);
+        if (next != uartRxTail) {
+            data = _utxr_rxr;
+            uartRxBuffer[head] = data;
+#if UART_RX_MIRROR_SIZE
+            if (head < UART_RX_MIRROR_SIZE) uartRxBuffer[UART_RX_BUFFER_SIZE + head] = data;
+#endif
+            uartRxHead = next; // Publish after the byte is stored
+        } else {
+            _acc = _utxr_rxr; // Drop the byte
+            if (uartRxOverflows != 0xFFFF) uartRxOverflows++;
+#if USE_UART_ERROR_STATS
+            uartErrorFlags |= UART_STATUS_RX_OVERFLOW;
+#endif
+        }
+    }
+}
+
+/** @brief Gets the number of bytes waiting in the receive ring buffer.
+ * @return The number of bytes that UART_Read() can return.
+ */
+unsigned char UART_Available(void) {
+    return (uartRxHead - uartRxTail) & (UART_RX_BUFFER_SIZE - 1);
+}
+
+/** @brief Reads up to length bytes from the receive ring buffer.
+ * @param buffer Destination for the bytes.
+ * @param length Maximum number of bytes to read.
+ * @return The number of bytes copied, 0 if none were waiting.
+ */
+unsigned char UART_Read(unsigned char *buffer, unsigned char length) {
+    unsigned char tail = uartRxTail;
+    unsigned char head = uartRxHead; // One snapshot, bytes arriving meanwhile wait for the next call
+    unsigned char count = 0;
+
+    while (count < length && tail != head) {
+        buffer[count++] = uartRxBuffer[tail];
+        tail = (tail + 1) & (UART_RX_BUFFER_SIZE - 1);
+    }
+    uartRxTail = tail; // Free the slots only after they are copied
+    return count;
+}
+
+/** @brief Gets the number of received bytes dropped because the ring buffer was full.
+ * @return The overflow count since UART_Init(), saturating at 0xFFFF.
+ */
+unsigned int UART_RxOverflowCount(void) {
+    unsigned int count;
+
+    // The ISR may update the two bytes between reads; repeat until stable
+    do {
+        count = uartRxOverflows;
+    } while (count != uartRxOverflows);
+    return count;
+}
+
+#if UART_RX_MIRROR_SIZE
+/** @brief Gets the waiting bytes in place, without copying.
+ * @return Pointer to the oldest waiting byte.
+ *
+ * Bytes past the end of the ring continue in the mirror, so a block that
+ * wraps around is still linear.
+ */
+unsigned char *UART_RxData(void) {
+    return (unsigned char *)&uartRxBuffer[uartRxTail];
+}
+
+/** @brief Releases bytes read through UART_RxData().
+ * @param count Number of bytes, at most UART_Available().
+ */
+void UART_RxSkip(unsigned char count) {
+    uartRxTail = (uartRxTail + count) & (UART_RX_BUFFER_SIZE - 1);
+}
+#endif
+#endif
+
+#if USE_UART_TX_BUFFER
+/** @brief Feeds the transmitter from the transmit ring buffer.
+ *
+ * Writes bytes while UTXIF shows the transmit register empty and switches
+ * the transmitter-empty interrupt off once the ring is drained.
+ */
+void UART_TxISR(void) {
+    unsigned char tail = uartTxTail;
+
+    while (_utxif && tail != uartTxHead) {
+        _utxr_rxr = uartTxBuffer[tail];
+        tail = (tail + 1) & (UART_TX_BUFFER_SIZE - 1);
+    }
+    uartTxTail = tail;
+
+    if (tail == uartTxHead) _uteie = 0; // Nothing left, UART_Write() turns it back on
+}
+
+/** @brief Queues bytes for transmission without waiting.
+ * @param data Bytes to send.
+ * @param length Number of bytes.
+ * @return The number of bytes queued; less than length if the ring buffer is full.
+ */
+unsigned char UART_Write(const unsigned char *data, unsigned char length) {
+    unsigned char head = uartTxHead;
+    unsigned char count = 0;
+    unsigned char next;
+
+    while (count < length) {
+        next = (head + 1) & (UART_TX_BUFFER_SIZE - 1);
+        if (next == uartTxTail) break; // Full
+        uartTxBuffer[head] = data[count++];
+        head = next;
+    }
+    uartTxHead = head; // Publish after the bytes are stored
+
+    // Single bit set: the ISR either still sees the new head or clears this after draining it
+    if (count) _uteie = 1;
+    return count;
+}
+
+/** @brief Gets the free space in the transmit ring buffer.
+ * @return The number of bytes UART_Write() can queue now.
+ */
+unsigned char UART_TxFree(void) {
+    return (UART_TX_BUFFER_SIZE - 1) - ((uartTxHead - uartTxTail) & (UART_TX_BUFFER_SIZE - 1));
+}
+
+/** @brief Waits until every queued byte has left the transmitter.
+ */
+void UART_Flush(void) {
+    while (uartTxTail != uartTxHead) {
+        if (!_emi) UART_TxISR(); // Nothing drains the ring with interrupts masked
+    }
+    while (!_utidle); // Last byte still shifting out
+}
+#endif
+
+#if USE_UART_ERROR_STATS
+/** @brief Counts one error, saturating at 0xFFFF.
+ */
+static void UART_CountError(unsigned char error) {
+    if (uartErrorCounts[error] != 0xFFFF) uartErrorCounts[error]++;
+}
+
+/** @brief Counts the error flags of the word waiting in the data register.
+ * @return UART_STATUS_* bits of the errors found, 0 for a clean word.
+ */
+unsigned char UART_RxErrors(void) {
+    unsigned char status = 0;
+
+    if (_uperr) {
+        status |= UART_STATUS_PARITY;
+        UART_CountError(UART_ERROR_PARITY);
+    }
+    if (_uferr) {
+        status |= UART_STATUS_FRAMING;
+        UART_CountError(UART_ERROR_FRAMING);
+    }
+    if (_uoerr) {
+        status |= UART_STATUS_OVERRUN;
+        UART_CountError(UART_ERROR_OVERRUN);
+    }
+    if (_unf) {
+        status |= UART_STATUS_NOISE;
+        UART_CountError(UART_ERROR_NOISE);
+    }
+    uartErrorFlags |= status; // Stays set after the counter saturates
+    return status;
+}
+
+/** @brief Gets the number of words received with an error.
+ * @param error One of UART_ERROR_PARITY .. UART_ERROR_RX_OVERFLOW.
+ * @return The count since UART_Init(), saturating at 0xFFFF.
+ */
+unsigned int UART_ErrorCount(unsigned char error) {
+    unsigned int count;
+
+    if (error >= UART_ERROR_RX_OVERFLOW) {
+#if USE_UART_RX_BUFFER
+        return (error == UART_ERROR_RX_OVERFLOW) ? UART_RxOverflowCount() : 0;
+#else
+        return 0;
+#endif
+    }
+
+    // The ISR may update the two bytes between reads; repeat until stable
+    do {
+        count = uartErrorCounts[error];
+    } while (count != uartErrorCounts[error]);
+    return count;
+}
+
+/** @brief Gets the errors seen since the previous call.
+ * @return UART_STATUS_* bits of the errors raised since the last call.
+ */
+unsigned char UART_ErrorStatus(void) {
+    unsigned char status = uartErrorFlags;
+
+    // Constant single-bit clears compile to one CLR, so a bit the ISR sets
+    // in between is never lost and interrupts stay on
+    if (status & UART_STATUS_PARITY) uartErrorFlags &= (unsigned char)~UART_STATUS_PARITY;
+    if (status & UART_STATUS_FRAMING) uartErrorFlags &= (unsigned char)~UART_STATUS_FRAMING;
+    if (status & UART_STATUS_OVERRUN) uartErrorFlags &= (unsigned char)~UART_STATUS_OVERRUN;
+    if (status & UART_STATUS_NOISE) uartErrorFlags &= (unsigned char)~UART_STATUS_NOISE;
+    if (status & UART_STATUS_RX_OVERFLOW) uartErrorFlags &= (unsigned char)~UART_STATUS_RX_OVERFLOW;
+    return status;
+}
+#endif
+
+#if USE_UART_MULTIDROP
+/** @brief Sets the address this node answers to.
+ * @param address Node address, UART_BROADCAST_ADDRESS is always accepted as well.
+ */
+void UART_SetNodeAddress(unsigned char address) {
+    unsigned char interrupts = _emi;
+
+    _emi = 0; // An address word in between would select the node under the old address
+    uartNodeAddress = address;
+    uartAddressed = 0;
+    _uadden = 1; // Wait for an address word again
+    _emi = interrupts;
+}
+
+/** @brief Tells whether the last address word selected this node.
+ * @return 1 while data words are received, 0 while they are dropped.
+ */
+unsigned char UART_Addressed(void) {
+    return uartAddressed;
+}
+
+/** @brief Waits until the transmitter has sent everything written to it.
+ */
+static void UART_WaitIdle(void) {
+#if USE_UART_TX_BUFFER
+    UART_Flush();
+#else
+    while (!_utidle);
+#endif
+}
+
+/** @brief Sends an address word (ninth bit set) to select a node.
+ * @param address Address of the node to select.
+ */
+void UART_TransmitAddress(unsigned char address) {
+    UART_WaitIdle(); // TX8 is taken with each word, keep it off queued data
+    _utx8 = 1;
+    UART_Transmit((char)address);
+    UART_WaitIdle();
+    _utx8 = 0;
+}
+#endif
@@ -16,6 +16,8 @@
 #ifndef UART_H
 #define UART_H
 
+#include "RCC.h"
+
 /** @brief Enable or disable macros. */
 #define ENABLE           	  1
 #define DISABLE               0
@@ -25,22 +27,44 @@
 #define RECEIVER         ENABLE
 
 //============================================
-// Assuming a clock frequency 
+// Baud rate, solved at compile time
+// The UART is clocked from fSYS (SYSTEM_CLOCK_HZ in RCC.h):
+//   UBRGH = 0 (low speed):  baud = fSYS / (64 * (UBRG + 1))
+//   UBRGH = 1 (high speed): baud = fSYS / (16 * (UBRG + 1))
+// Both settings are rounded to the nearest UBRG and the one with the smaller
+// error is written by UART_Init(). The build fails if that error is larger
+// than UART_MAX_BAUD_ERROR_PERMILLE.
 //============================================
-#define F_CPU            4000000 /**< Clock frequency in Hz. */
+#define UART_BAUD_RATE               9600UL /**< Baud rate in bit/s. */
+#define UART_MAX_BAUD_ERROR_PERMILLE 20     /**< Largest accepted baud error, 0.1 % units (2 %). */
 
-//============================================
-// Calculate and set the baud rate
-// UBRGH: Baud Rate speed selection
-//============================================
 #define LOW_SPEED             0
 #define HIGH_SPEED            1
-#define SPEED_BAUDRATE   LOW_SPEED /**< Current baud rate setting. */
 
-#if SPEED_BAUDRATE
-	#define CONSTANT_NUMBER 16.00 /**< Constant for low speed calculation. */
+#define UART_LOW_SPEED_DIVISOR   64UL /**< fSYS / baud / (UBRG + 1) with UBRGH = 0. */
+#define UART_HIGH_SPEED_DIVISOR  16UL /**< fSYS / baud / (UBRG + 1) with UBRGH = 1. */
+
+// UBRG + 1 rounded to nearest, and the resulting error in 0.1 % (1000 if out of range)
+#define UART_BAUD_STEPS(divisor)  ((SYSTEM_CLOCK_HZ + (divisor) * UART_BAUD_RATE / 2) / ((divisor) * UART_BAUD_RATE))
+#define UART_BAUD_CLOCK(divisor)  ((divisor) * UART_BAUD_RATE * UART_BAUD_STEPS(divisor))
+#define UART_BAUD_ERROR(divisor) \
+    ((UART_BAUD_STEPS(divisor) < 1 || UART_BAUD_STEPS(divisor) > 256) ? 1000UL : \
+     ((SYSTEM_CLOCK_HZ > UART_BAUD_CLOCK(divisor)) ? SYSTEM_CLOCK_HZ - UART_BAUD_CLOCK(divisor) \
+                                                   : UART_BAUD_CLOCK(divisor) - SYSTEM_CLOCK_HZ) * 100UL / (UART_BAUD_CLOCK(divisor) / 10))
+
+#if UART_BAUD_ERROR(UART_HIGH_SPEED_DIVISOR) <= UART_BAUD_ERROR(UART_LOW_SPEED_DIVISOR)
+	#define SPEED_BAUDRATE   HIGH_SPEED /**< Solved UBRGH setting. */
+	#define CONSTANT_NUMBER  UART_HIGH_SPEED_DIVISOR /**< Divisor for high speed. */
 #else
-	#define CONSTANT_NUMBER 64.00 /**< Constant for high speed calculation. */
+	#define SPEED_BAUDRATE   LOW_SPEED /**< Solved UBRGH setting. */
+	#define CONSTANT_NUMBER  UART_LOW_SPEED_DIVISOR /**< Divisor for low speed. */
+#endif
+
+#define UART_UBRG                 (UART_BAUD_STEPS(CONSTANT_NUMBER) - 1) /**< Solved UBRG value. */
+#define UART_BAUD_ERROR_PERMILLE  UART_BAUD_ERROR(CONSTANT_NUMBER)      /**< Error of the solved setting, 0.1 % units. */
+
+#if UART_BAUD_ERROR_PERMILLE > UART_MAX_BAUD_ERROR_PERMILLE
+#error "UART_BAUD_RATE cannot be reached from SYSTEM_CLOCK_HZ within UART_MAX_BAUD_ERROR_PERMILLE"
 #endif
 
 //============================================
@@ -75,52 +99,136 @@
 */
 //============================================
 
-#define CHECK_RECEIVER_ERROR DISABLE /**< Enable or disable receiver error checking. */
-
 //============================================
-// UART error codes
+// Receive error statistics
+// Received bytes are always returned as data. The error flags of each
+// received word are counted out of band instead, before the data register
+// is read (reading UUSR then UTXR_RXR clears them). Counters saturate at
+// 0xFFFF and are only written by the receive path, so reading them never
+// masks interrupts; compare two readings to get a rate.
 //============================================
-#define UART_ERROR          -1 /**< UART generic error code. */
-#define UART_FRAMING_ERROR  -2 /**< Framing error code. */
-#define UART_PARITY_ERROR   -3 /**< Parity error code. */
-#define UART_OVERRUN_ERROR  -4 /**< Overrun error code. */
+#define USE_UART_ERROR_STATS ENABLE /**< Enable or disable the receive error counters. */
+
+#define UART_ERROR_PARITY       0 /**< UPERR: parity bit did not match. */
+#define UART_ERROR_FRAMING      1 /**< UFERR: stop bit was low. */
+#define UART_ERROR_OVERRUN      2 /**< UOERR: a word was lost before the data register was read. */
+#define UART_ERROR_NOISE        3 /**< UNF: the bit samples of a word disagreed. */
+#define UART_ERROR_RX_OVERFLOW  4 /**< Word dropped because the receive ring buffer was full. */
+#define UART_ERROR_TYPES        5
+
+/** @brief Bits of UART_ErrorStatus(), one per error type. */
+#define UART_STATUS_PARITY       (1 << UART_ERROR_PARITY)
+#define UART_STATUS_FRAMING      (1 << UART_ERROR_FRAMING)
+#define UART_STATUS_OVERRUN      (1 << UART_ERROR_OVERRUN)
+#define UART_STATUS_NOISE        (1 << UART_ERROR_NOISE)
+#define UART_STATUS_RX_OVERFLOW  (1 << UART_ERROR_RX_OVERFLOW)
 
 //============================================          
 #define TRANSMITTER_IDLE_INTERRUPT DISABLE /**< Enable or disable transmitter idle interrupt. */
-#define TRANSMITTER_EMPTY_INTERRUPT DISABLE /**< Enable or disable transmitter empty interrupt. */
+#define TRANSMITTER_EMPTY_INTERRUPT DISABLE /**< Enable or disable transmitter empty interrupt (driven by USE_UART_TX_BUFFER when enabled). */
 #define RECEIVER_INTERRUPT ENABLE /**< Enable or disable receiver interrupt. */
 
+//============================================
+// Interrupt-driven receive buffer
+// The USIM interrupt moves every received byte into a ring buffer, so
+// bytes are kept while the main loop is busy (e.g. during ADC bursts).
+// The ISR only writes the head and main code only writes the tail,
+// so reading never masks interrupts.
+//============================================
+#define USE_UART_RX_BUFFER   ENABLE /**< Enable or disable the receive ring buffer. */
+
+// COBS + CRC-16 framing in UARTFrame.h; it needs a ring that holds a whole
+// frame and the mirror below, so it also decides their sizes
+#define USE_UART_FRAME       DISABLE /**< Enable or disable the framing layer (UARTFrame.h). */
+
+// Bytes written to slots 0..UART_RX_MIRROR_SIZE - 1 are copied behind the
+// ring as well, so UART_RxData() can hand out that many bytes (plus one)
+// from any position as one linear block. 0 disables the mirror.
+#if USE_UART_FRAME
+#define UART_RX_BUFFER_SIZE  32     /**< Ring length, a power of two up to 128 (holds size - 1 bytes). RAM: 32 bytes. */
+#define UART_RX_MIRROR_SIZE  19     /**< UART_FRAME_MAX_ENCODED. RAM: 19 bytes behind the ring. */
+#else
+#define UART_RX_BUFFER_SIZE  16     /**< Ring length, a power of two up to 128 (holds size - 1 bytes). RAM: 16 bytes. */
+#define UART_RX_MIRROR_SIZE  0      /**< Only the framing layer reads the ring in place. RAM: none. */
+#endif
+
+#if (UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) != 0 || UART_RX_BUFFER_SIZE > 128
+#error "UART_RX_BUFFER_SIZE must be a power of two up to 128"
+#endif
+#if USE_UART_RX_BUFFER && !RECEIVER_INTERRUPT
+#error "USE_UART_RX_BUFFER needs RECEIVER_INTERRUPT"
+#endif
+
+//============================================
+// Interrupt-driven transmit buffer
+// UART_Write() copies into a ring buffer and returns at once. The
+// transmitter-empty interrupt (UTEIE) is switched on while the ring holds
+// data and feeds UTXR from the USIM interrupt; it switches itself off when
+// the ring runs empty. Main code only writes the head, the ISR the tail.
+//============================================
+#define USE_UART_TX_BUFFER   ENABLE /**< Enable or disable the transmit ring buffer. */
+#define UART_TX_BUFFER_SIZE  16     /**< Ring length, a power of two up to 128 (holds size - 1 bytes). RAM: 16 bytes. */
+
+#if (UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) != 0 || UART_TX_BUFFER_SIZE > 128
+#error "UART_TX_BUFFER_SIZE must be a power of two up to 128"
+#endif
+
+//============================================
+// 9-bit multidrop addressing (RS-485 bus)
+// A word with the ninth bit set is a node address, the words after it are
+// data for that node. While the node is not addressed, ADDEN makes the
+// receiver drop data words without setting URXIF, so the CPU can stay in
+// IDLE1 (Enter_Idle1_Mode(), the UART keeps its clock) and only wakes for
+// address words. A matching address clears ADDEN until the next address
+// word selects another node. UART_TransmitAddress() sends an address word.
+//============================================
+#define USE_UART_MULTIDROP      DISABLE /**< Enable or disable multidrop addressing. */
+#define UART_NODE_ADDRESS       0x01    /**< Address of this node after UART_Init(). */
+#define UART_BROADCAST_ADDRESS  0xFF    /**< Address every node accepts. */
+
+#if USE_UART_MULTIDROP
+#if DATA_TRANSFER != _9_BIT_DATA_TRANSFER || PARITY
+#error "USE_UART_MULTIDROP needs DATA_TRANSFER = _9_BIT_DATA_TRANSFER without parity"
+#endif
+#if !USE_UART_RX_BUFFER
+#error "USE_UART_MULTIDROP needs USE_UART_RX_BUFFER"
+#endif
+#endif
+
 /** @brief Receives a single character via UART.
  * @return The received character.
  *
- * This function checks if data is available and then receives a single character via UART.
- * It is a non-blocking function, which means it does not wait if no data is available.
+ * This function waits until data is available and then receives a single character via UART.
+ * With USE_UART_RX_BUFFER the character is taken from the receive ring buffer.
+ * Receive errors never replace the data, see UART_ErrorCount().
  */
 char UART_Receive(void);
 
-/** @brief Initializes the UART with a specified baud rate.
- * @param baudrate The baud rate for UART communication.
+/** @brief Initializes the UART at UART_BAUD_RATE.
  *
- * This function configures the UART pins, sets the UART mode, and calculates the
- * baud rate register values based on the provided baud rate.
+ * This function configures the UART pins, sets the UART mode, and writes the
+ * baud rate registers with the constants solved from SYSTEM_CLOCK_HZ.
  */
-void UART_Init(unsigned int baudrate);
+void UART_Init(void);
 
 /** @brief Transmits a single character via UART.
  * @param data The character to be transmitted.
  *
  * This function waits until the transmit buffer is empty and then sends the data
- * through the UART.
+ * through the UART. With USE_UART_TX_BUFFER it waits only for room in the ring buffer.
  */
 void UART_Transmit(char data);
 
 /** @brief Receives a single character via UART in a non-blocking manner.
- * @return The received character if available; otherwise, an error code.
+ * @param data Where to store the received character; left unchanged if none.
+ * @return 1 if a character was received, 0 if none was available.
  *
  * This function checks if data is available and then receives a single character via UART.
  * It is non-blocking and suitable for use in interrupt service routines.
+ * With USE_UART_RX_BUFFER the character is taken from the receive ring buffer.
+ * A received 0x00 is data like any other byte, so test the return value.
  */
-char UART_ReceiveNonBlocking(void);
+unsigned char UART_ReceiveNonBlocking(unsigned char *data);
 
 /** @brief Enables UART interrupts for receiving and transmitting.
  *
@@ -134,4 +242,123 @@ void UART_EnableInterrupts(void);
  */
 void UART_DisableInterrupts(void);
 
+#if USE_UART_RX_BUFFER
+/** @brief Moves received bytes into the receive ring buffer.
+ *
+ * Call from the USIM interrupt service routine.
+ */
+void UART_RxISR(void);
+
+/** @brief Gets the number of bytes waiting in the receive ring buffer.
+ * @return The number of bytes that UART_Read() can return.
+ */
+unsigned char UART_Available(void);
+
+/** @brief Reads up to length bytes from the receive ring buffer.
+ * @param buffer Destination for the bytes.
+ * @param length Maximum number of bytes to read.
+ * @return The number of bytes copied, 0 if none were waiting.
+ *
+ * Never waits and never disables interrupts.
+ */
+unsigned char UART_Read(unsigned char *buffer, unsigned char length);
+
+/** @brief Gets the number of received bytes dropped because the ring buffer was full.
+ * @return The overflow count since UART_Init(), saturating at 0xFFFF.
+ *
+ * Same as UART_ErrorCount(UART_ERROR_RX_OVERFLOW).
+ */
+unsigned int UART_RxOverflowCount(void);
+
+#if UART_RX_MIRROR_SIZE
+/** @brief Gets the waiting bytes in place, without copying.
+ * @return Pointer to the oldest waiting byte. The next UART_Available()
+ *         bytes, up to UART_RX_MIRROR_SIZE + 1 of them, are contiguous and
+ *         stay valid until UART_RxSkip() releases them.
+ */
+unsigned char *UART_RxData(void);
+
+/** @brief Releases bytes read through UART_RxData().
+ * @param count Number of bytes, at most UART_Available().
+ */
+void UART_RxSkip(unsigned char count);
+#endif
+#endif
+
+#if USE_UART_TX_BUFFER
+/** @brief Feeds the transmitter from the transmit ring buffer.
+ *
+ * Call from the USIM interrupt service routine.
+ */
+void UART_TxISR(void);
+
+/** @brief Queues bytes for transmission without waiting.
+ * @param data Bytes to send.
+ * @param length Number of bytes.
+ * @return The number of bytes queued; less than length if the ring buffer is full.
+ */
+unsigned char UART_Write(const unsigned char *data, unsigned char length);
+
+/** @brief Gets the free space in the transmit ring buffer.
+ * @return The number of bytes UART_Write() can queue now.
+ */
+unsigned char UART_TxFree(void);
+
+/** @brief Waits until every queued byte has left the transmitter.
+ *
+ * Returns once the ring buffer is empty and UTIDLE shows the shift register
+ * is idle, so it is safe to stop the clock (e.g. before Enter_Idle0_Mode()).
+ * Drains the ring by polling when interrupts are masked.
+ */
+void UART_Flush(void);
+#endif
+
+#if USE_UART_ERROR_STATS
+/** @brief Counts the error flags of the word waiting in the data register.
+ * @return UART_STATUS_* bits of the errors found, 0 for a clean word.
+ *
+ * Called by the receive paths before they read UTXR_RXR; an ISR that reads
+ * the data register itself (e.g. ModbusRxISR()) calls it the same way.
+ */
+unsigned char UART_RxErrors(void);
+
+/** @brief Gets the number of words received with an error.
+ * @param error One of UART_ERROR_PARITY .. UART_ERROR_RX_OVERFLOW.
+ * @return The count since UART_Init(), saturating at 0xFFFF.
+ */
+unsigned int UART_ErrorCount(unsigned char error);
+
+/** @brief Gets the errors seen since the previous call.
+ * @return UART_STATUS_* bits of the errors raised since the last call
+ *         (or since UART_Init()).
+ *
+ * The receive path sets a sticky flag for every error, also once its counter
+ * has saturated. Only the returned bits are cleared, one at a time, so an
+ * error raised by the interrupt meanwhile is reported by the next call.
+ */
+unsigned char UART_ErrorStatus(void);
+#endif
+
+#if USE_UART_MULTIDROP
+/** @brief Sets the address this node answers to.
+ * @param address Node address, UART_BROADCAST_ADDRESS is always accepted as well.
+ *
+ * The node stays unaddressed until the next address word selects it.
+ */
+void UART_SetNodeAddress(unsigned char address);
+
+/** @brief Tells whether the last address word selected this node.
+ * @return 1 while data words are received, 0 while they are dropped.
+ */
+unsigned char UART_Addressed(void);
+
+/** @brief Sends an address word (ninth bit set) to select a node.
+ * @param address Address of the node to select.
+ *
+ * Waits until queued data has left the transmitter, so the ninth bit only
+ * goes out with the address word.
+ */
+void UART_TransmitAddress(unsigned char address);
+#endif
+
 #endif // UART_H
@@ -0,0 +1,217 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file UARTAutoBaud.c
+ * @brief Implementation of UART auto-baud detection with PTM input capture.
+ *
+ * The interrupts only add up intervals; the division that turns the sum of
+ * nine bit times into UBRG runs in UART_AutoBaudStatus() on the main side.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "UARTAutoBaud.h"
+
+#if USE_UART_AUTOBAUD
+
+// PTIO1:PTIO0 in capture input mode: capture on both PTPI edges
+#define UART_AUTOBAUD_CAPTURE_DUAL_EDGE  2
+
+static volatile unsigned char autoBaudState;
+static volatile unsigned char autoBaudMeasured; // Set by the ISR once nine intervals are summed
+static volatile unsigned char autoBaudEdges;    // Edges of the current sync byte
+static volatile unsigned int autoBaudWraps;     // PTM wraps since the last edge
+static volatile unsigned int autoBaudTimeout;   // PTM wraps left
+static volatile unsigned long autoBaudFirst;    // First interval, the reference bit time
+static unsigned long autoBaudMargin;            // Tolerance around it, latched with it
+static volatile unsigned long autoBaudTotal;    // Sum of the intervals so far
+static unsigned long autoBaudRate;
+
+/**
+ * @brief Stop the PTM and its interrupts.
+ */
+static void UART_AutoBaudStopTimer(void)
+{
+    _ptmae = 0;
+    _ptmpe = 0;
+    _pton = 0;
+}
+
+/**
+ * @brief Start waiting for the sync byte.
+ */
+void UART_AutoBaudStart(void)
+{
+    _urxen = 0; // Nothing valid can be received until the rate is known
+
+    _pton = 0;
+    _ptck0 = PTIMER_CLOCK & 1;
+    _ptck1 = (PTIMER_CLOCK >> 1) & 1;
+    _ptck2 = (PTIMER_CLOCK >> 2) & 1;
+    _ptm0 = PTM_CAPTURE_INPUT_MODE & 1;
+    _ptm1 = (PTM_CAPTURE_INPUT_MODE >> 1) & 1;
+    _ptio0 = UART_AUTOBAUD_CAPTURE_DUAL_EDGE & 1;
+    _ptio1 = (UART_AUTOBAUD_CAPTURE_DUAL_EDGE >> 1) & 1;
+    _ptcapts = PTM_PTPI_INPUT;
+
+    // Clear the counter on every edge, so each capture is one interval
+    _pttclr0 = PTM_COMPARE_P_MATCH_OR_PTCK_PTPI_DUAL_EDGE & 1;
+    _pttclr1 = (PTM_COMPARE_P_MATCH_OR_PTCK_PTPI_DUAL_EDGE >> 1) & 1;
+
+    // CCRP = 0: period match every 1024 counts
+    _ptmrpl = 0;
+    _ptmrph = 0;
+
+    autoBaudMeasured = 0;
+    autoBaudEdges = 0;
+    autoBaudWraps = 0;
+    autoBaudTimeout = UART_AUTOBAUD_TIMEOUT_WRAPS;
+    autoBaudTotal = 0;
+    autoBaudRate = 0;
+    autoBaudState = UART_AUTOBAUD_RUNNING;
+
+    _ptmaf = 0;
+    _ptmpf = 0;
+    _ptmae = 1;
+    _ptmpe = 1;
+    _pton = 1;
+}
+
+/**
+ * @brief Record one edge of the sync byte.
+ *
+ * The first edge after a long idle is the falling edge of the start bit.
+ * An interval outside the tolerance restarts the byte at the current edge.
+ */
+void UART_AutoBaudCaptureISR(void)
+{
+    unsigned long interval;
+
+    if (autoBaudState != UART_AUTOBAUD_RUNNING || autoBaudMeasured)
+    {
+        return;
+    }
+
+    interval = ((unsigned long)autoBaudWraps * UART_AUTOBAUD_WRAP_COUNTS) |
+               ((unsigned int)(_ptmah & 3) << 8) | _ptmal;
+    autoBaudWraps = 0;
+
+    if (autoBaudEdges == 0 || interval > UART_AUTOBAUD_MAX_INTERVAL)
+    {
+        autoBaudEdges = 1; // Start bit
+        autoBaudTotal = 0;
+        return;
+    }
+
+    if (autoBaudEdges == 1)
+    {
+        autoBaudFirst = interval;
+        autoBaudMargin = interval >> UART_AUTOBAUD_TOLERANCE_SHIFT;
+    }
+    else
+    {
+        if (interval > autoBaudFirst + autoBaudMargin || interval + autoBaudMargin < autoBaudFirst)
+        {
+            autoBaudEdges = 1; // Not a 0x55, try again from this edge
+            autoBaudTotal = 0;
+            return;
+        }
+    }
+
+    autoBaudTotal += interval;
+    if (++autoBaudEdges > UART_AUTOBAUD_SYNC_INTERVALS)
+    {
+        UART_AutoBaudStopTimer();
+        autoBaudMeasured = 1;
+    }
+}
+
+/**
+ * @brief Count one PTM wrap.
+ *
+ * The counter is cleared on every edge, so a period match means at least
+ * 1024 counts without an edge.
+ */
+void UART_AutoBaudPeriodISR(void)
+{
+    if (autoBaudState != UART_AUTOBAUD_RUNNING || autoBaudMeasured)
+    {
+        return;
+    }
+
+    if (autoBaudWraps != 0xFFFF)
+    {
+        autoBaudWraps++;
+    }
+    if (--autoBaudTimeout == 0)
+    {
+        UART_AutoBaudStopTimer();
+        autoBaudState = UART_AUTOBAUD_TIMEOUT;
+    }
+}
+
+/**
+ * @brief Get the detection state.
+ *
+ * @return One of UART_AUTOBAUD_IDLE .. UART_AUTOBAUD_OUT_OF_RANGE.
+ */
+unsigned char UART_AutoBaudStatus(void)
+{
+    unsigned long clocks;
+    unsigned long steps;
+    unsigned char highSpeed = 1;
+
+    if (autoBaudState == UART_AUTOBAUD_TIMEOUT)
+    {
+        _urxen = RECEIVER; // Keep the previous rate
+        return autoBaudState;
+    }
+    if (autoBaudState != UART_AUTOBAUD_RUNNING || !autoBaudMeasured)
+    {
+        return autoBaudState;
+    }
+
+    // fSYS clocks in nine bit times; UBRG + 1 = clocks / (9 * divisor), rounded
+    clocks = autoBaudTotal * UART_AUTOBAUD_CLOCK_RATIO;
+    steps = (clocks + UART_AUTOBAUD_SYNC_INTERVALS * UART_HIGH_SPEED_DIVISOR / 2) /
+            (UART_AUTOBAUD_SYNC_INTERVALS * UART_HIGH_SPEED_DIVISOR);
+    if (steps > 256)
+    {
+        highSpeed = 0; // Too slow for UBRGH = 1
+        steps = (clocks + UART_AUTOBAUD_SYNC_INTERVALS * UART_LOW_SPEED_DIVISOR / 2) /
+                (UART_AUTOBAUD_SYNC_INTERVALS * UART_LOW_SPEED_DIVISOR);
+    }
+
+    autoBaudRate = (PTM_CLOCK_HZ * UART_AUTOBAUD_SYNC_INTERVALS + (autoBaudTotal >> 1)) / autoBaudTotal;
+    if (steps < 1 || steps > 256)
+    {
+        autoBaudState = UART_AUTOBAUD_OUT_OF_RANGE;
+        _urxen = RECEIVER; // Keep the previous rate
+        return autoBaudState;
+    }
+
+    _ubrgh = highSpeed;
+    _ubrg = (unsigned char)(steps - 1);
+    _urxen = RECEIVER;
+
+    autoBaudState = UART_AUTOBAUD_DONE;
+    return autoBaudState;
+}
+
+/**
+ * @brief Get the measured rate.
+ *
+ * @return The rate in bit/s measured from the last sync byte, 0 if none.
+ */
+unsigned long UART_AutoBaudRate(void)
+{
+    return autoBaudRate;
+}
+
+#endif
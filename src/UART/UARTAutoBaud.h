@@ -0,0 +1,121 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file UARTAutoBaud.h
+ * @brief Header file for UART auto-baud detection with PTM input capture.
+ *
+ * The peer sends the sync byte 0x55. On the line that is a start bit and
+ * eight data bits alternating 0/1, so the ten bits give nine intervals of
+ * one bit time between ten edges. The PTM runs in capture input mode on both
+ * edges and is cleared by every edge, so each CCRA capture is the length of
+ * one interval; PTM period matches count the 1024-count wraps in between and
+ * the timeout. Everything runs in the PTM interrupts, the CPU is free (or in
+ * IDLE) until UART_AutoBaudStatus() reports a result.
+ *
+ * The RX pin must also drive the PTM capture input (PTPI, see the IFS0
+ * setting in PTimerInit()). The receiver is off while detecting. Every edge
+ * has to be serviced before the next one overwrites CCRA, which limits
+ * detection to about 19200 baud at 8 MHz. The PTM is left off afterwards;
+ * call PTimerInit() to use it for something else.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef UART_AUTO_BAUD_H
+#define UART_AUTO_BAUD_H
+
+#include "UART.h"
+#include "PTM.h"
+#include "ADCTrigger.h"
+
+// Enable or Disable auto-baud detection
+#define USE_UART_AUTOBAUD           ENABLE
+
+// Give up if no valid sync byte arrives within this time
+#define UART_AUTOBAUD_TIMEOUT_MS    2000UL
+
+// Slowest rate accepted; longer intervals restart the sync byte
+#define UART_AUTOBAUD_MIN_BAUD      1200UL
+
+// Every interval must be within 1/2^UART_AUTOBAUD_TOLERANCE_SHIFT of the first one (2: 1/4 = 25 %)
+#define UART_AUTOBAUD_TOLERANCE_SHIFT  2
+
+// Detection states
+#define UART_AUTOBAUD_IDLE          0 /**< Not started */
+#define UART_AUTOBAUD_RUNNING       1 /**< Waiting for the sync byte */
+#define UART_AUTOBAUD_DONE          2 /**< UART programmed with the measured rate */
+#define UART_AUTOBAUD_TIMEOUT       3 /**< No valid sync byte before the timeout */
+#define UART_AUTOBAUD_OUT_OF_RANGE  4 /**< Measured rate has no UBRG setting */
+
+#define UART_AUTOBAUD_SYNC_INTERVALS  9 /**< Bit times between the first and last edge of 0x55 */
+#define UART_AUTOBAUD_WRAP_COUNTS     1024UL /**< PTM counts per period match (CCRP = 0) */
+
+#if USE_UART_AUTOBAUD
+
+#ifndef PTM_CLOCK_HZ
+#error "Auto-baud needs the PTM on an internal clock with a known frequency"
+#endif
+#if PTM_CLOCK_HZ > SYSTEM_CLOCK_HZ || (SYSTEM_CLOCK_HZ % PTM_CLOCK_HZ) != 0
+#error "Auto-baud needs a PTM clock of fSYS, fSYS/4, fH/16 or fH/64"
+#endif
+#if USE_ADC_TIMER_TRIGGER && (ADC_TRIGGER_SOURCE == ADC_TRIGGER_PTM)
+#error "Auto-baud and the ADC trigger cannot share the PTM"
+#endif
+
+// fSYS counts per PTM count, and the timeout and interval limit in PTM units
+#define UART_AUTOBAUD_CLOCK_RATIO     (SYSTEM_CLOCK_HZ / PTM_CLOCK_HZ)
+#define UART_AUTOBAUD_TIMEOUT_WRAPS   (UART_AUTOBAUD_TIMEOUT_MS * (PTM_CLOCK_HZ / 1000UL) / UART_AUTOBAUD_WRAP_COUNTS)
+#define UART_AUTOBAUD_MAX_INTERVAL    (PTM_CLOCK_HZ / UART_AUTOBAUD_MIN_BAUD + (PTM_CLOCK_HZ / UART_AUTOBAUD_MIN_BAUD >> UART_AUTOBAUD_TOLERANCE_SHIFT))
+
+#if UART_AUTOBAUD_TIMEOUT_WRAPS > 65535UL || UART_AUTOBAUD_TIMEOUT_WRAPS < 1
+#error "UART_AUTOBAUD_TIMEOUT_MS does not fit the PTM clock"
+#endif
+
+/**
+ * @brief Start waiting for the sync byte.
+ *
+ * Switches the receiver off and takes over the PTM in capture input mode.
+ */
+void UART_AutoBaudStart(void);
+
+/**
+ * @brief Get the detection state.
+ *
+ * Call from the main loop. Once the sync byte is measured, this programs
+ * UBRGH/UBRG with the nearest achievable rate, switches the receiver back on
+ * and returns UART_AUTOBAUD_DONE.
+ *
+ * @return One of UART_AUTOBAUD_IDLE .. UART_AUTOBAUD_OUT_OF_RANGE.
+ */
+unsigned char UART_AutoBaudStatus(void);
+
+/**
+ * @brief Get the measured rate.
+ *
+ * @return The rate in bit/s measured from the last sync byte, 0 if none.
+ */
+unsigned long UART_AutoBaudRate(void);
+
+/**
+ * @brief Record one edge of the sync byte.
+ *
+ * Call from the PTM comparator A (capture) interrupt service routine.
+ */
+void UART_AutoBaudCaptureISR(void);
+
+/**
+ * @brief Count one PTM wrap.
+ *
+ * Call from the PTM comparator P (period) interrupt service routine.
+ */
+void UART_AutoBaudPeriodISR(void);
+
+#endif
+
+#endif // UART_AUTO_BAUD_H
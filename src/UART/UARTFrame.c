@@ -0,0 +1,254 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file UARTFrame.c
+ * @brief Implementation of COBS + CRC-16 packet framing over the UART ring buffers.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "UARTFrame.h"
+
+#if USE_UART_FRAME
+
+// CRC-16/CCITT-FALSE of one nibble, 32 bytes of ROM instead of 512
+static const unsigned int uartFrameCrcTable[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+static unsigned char uartFrameHeld;       // Ring bytes of the frame handed out, delimiter included
+static unsigned char uartFrameScanned;    // Bytes already searched for the delimiter
+static unsigned char uartFrameDiscarding; // Dropping an overlong frame up to its delimiter
+static unsigned int uartFrameErrors;
+
+/**
+ * @brief Update a CRC-16/CCITT-FALSE with one byte.
+ *
+ * @param crc CRC so far, 0xFFFF to start.
+ * @param data Next byte.
+ * @return The updated CRC.
+ */
+unsigned int UART_FrameCrc(unsigned int crc, unsigned char data)
+{
+    crc = ((crc << 4) & 0xFFFF) ^ uartFrameCrcTable[((crc >> 12) ^ (data >> 4)) & 0x0F];
+    crc = ((crc << 4) & 0xFFFF) ^ uartFrameCrcTable[((crc >> 12) ^ data) & 0x0F];
+    return crc;
+}
+
+/**
+ * @brief Count one dropped frame.
+ */
+static void UART_FrameCountError(void)
+{
+    if (uartFrameErrors != 0xFFFF)
+    {
+        uartFrameErrors++;
+    }
+}
+
+/**
+ * @brief Decode a COBS block in place.
+ *
+ * The decoded bytes never run ahead of the encoded ones, so the output can
+ * overwrite the input.
+ *
+ * @param frame Encoded bytes, without the delimiter.
+ * @param length Number of encoded bytes.
+ * @return The decoded length, 0 for a malformed block.
+ */
+static unsigned char UART_FrameDecode(unsigned char *frame, unsigned char length)
+{
+    unsigned char read = 0;
+    unsigned char write = 0;
+    unsigned char code;
+    unsigned char i;
+
+    while (read < length)
+    {
+        code = frame[read++];
+        if (code == 0 || (unsigned char)(code - 1) > (unsigned char)(length - read))
+        {
+            return 0; // Code byte points past the delimiter
+        }
+        for (i = 1; i < code; i++)
+        {
+            frame[write++] = frame[read++];
+        }
+        if (code != 0xFF && read < length)
+        {
+            frame[write++] = 0; // Every block but the last ends with a zero
+        }
+    }
+    return write;
+}
+
+/**
+ * @brief Release the frame returned by UART_FrameReceive().
+ */
+void UART_FrameRelease(void)
+{
+    if (uartFrameHeld)
+    {
+        UART_RxSkip(uartFrameHeld);
+        uartFrameHeld = 0;
+    }
+}
+
+/**
+ * @brief Get the next valid received frame.
+ *
+ * @param length Receives the payload length.
+ * @return Pointer to the payload, or 0 if no complete frame is waiting.
+ */
+unsigned char *UART_FrameReceive(unsigned char *length)
+{
+    unsigned char *frame;
+    unsigned char available;
+    unsigned char end;
+    unsigned char decoded;
+    unsigned char i;
+    unsigned int crc;
+
+    UART_FrameRelease();
+
+    for (;;)
+    {
+        available = UART_Available();
+        frame = UART_RxData();
+
+        // Continue the search where the last call stopped
+        end = uartFrameScanned;
+        while (end < available && end <= UART_FRAME_MAX_ENCODED && frame[end] != UART_FRAME_DELIMITER)
+        {
+            end++;
+        }
+
+        if (end > UART_FRAME_MAX_ENCODED)
+        {
+            // Too long for any frame: free the ring and drop bytes up to the next delimiter
+            UART_RxSkip(end);
+            uartFrameScanned = 0;
+            if (!uartFrameDiscarding)
+            {
+                uartFrameDiscarding = 1;
+                UART_FrameCountError();
+            }
+            continue;
+        }
+        if (end == available)
+        {
+            uartFrameScanned = end; // Frame not complete yet
+            return 0;
+        }
+
+        uartFrameScanned = 0;
+        if (uartFrameDiscarding || end == 0)
+        {
+            // End of a dropped frame, or an empty frame between two delimiters
+            uartFrameDiscarding = 0;
+            UART_RxSkip(end + 1);
+            continue;
+        }
+
+        // A CRC sent high byte first leaves a zero remainder over payload and CRC
+        decoded = UART_FrameDecode(frame, end);
+        crc = 0xFFFF;
+        for (i = 0; i < decoded; i++)
+        {
+            crc = UART_FrameCrc(crc, frame[i]);
+        }
+        if (decoded < UART_FRAME_CRC_SIZE || crc != 0)
+        {
+            UART_RxSkip(end + 1);
+            UART_FrameCountError();
+            continue;
+        }
+
+        uartFrameHeld = end + 1;
+        *length = decoded - UART_FRAME_CRC_SIZE;
+        return frame;
+    }
+}
+
+/**
+ * @brief Get one byte of payload followed by the CRC.
+ */
+static unsigned char UART_FrameByte(const unsigned char *data, unsigned char length, unsigned int crc, unsigned char index)
+{
+    if (index < length)
+    {
+        return data[index];
+    }
+    return (index == length) ? (unsigned char)(crc >> 8) : (unsigned char)crc;
+}
+
+/**
+ * @brief Encode and queue one frame.
+ *
+ * @param data Payload.
+ * @param length Payload length, at most UART_FRAME_MAX_SEND.
+ * @return 1 if the frame was queued, 0 if it was too long and nothing was sent.
+ */
+unsigned char UART_FrameSend(const unsigned char *data, unsigned char length)
+{
+    unsigned char total;
+    unsigned char start = 0;
+    unsigned char end;
+    unsigned char i;
+    unsigned int crc = 0xFFFF;
+
+    if (length > UART_FRAME_MAX_SEND)
+    {
+        return 0; // The total would wrap the 8-bit counters below
+    }
+    total = length + UART_FRAME_CRC_SIZE;
+
+    for (i = 0; i < length; i++)
+    {
+        crc = UART_FrameCrc(crc, data[i]);
+    }
+
+    for (;;)
+    {
+        // Look ahead to the next zero: its distance is the COBS code byte
+        end = start;
+        while (end < total && UART_FrameByte(data, length, crc, end) != 0)
+        {
+            end++;
+        }
+
+        UART_Transmit((char)(end - start + 1));
+        for (i = start; i < end; i++)
+        {
+            UART_Transmit((char)UART_FrameByte(data, length, crc, i));
+        }
+
+        if (end >= total)
+        {
+            break;
+        }
+        start = end + 1; // The zero itself is implied by the code byte
+    }
+
+    UART_Transmit(UART_FRAME_DELIMITER);
+    return 1;
+}
+
+/**
+ * @brief Get the number of dropped frames.
+ *
+ * @return Frames dropped since start-up, saturating at 0xFFFF.
+ */
+unsigned int UART_FrameErrorCount(void)
+{
+    return uartFrameErrors;
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file UARTFrame.h
+ * @brief Header file for COBS + CRC-16 packet framing over the UART ring buffers.
+ *
+ * On the wire a frame is COBS(payload, CRC-16) followed by a 0x00 delimiter.
+ * COBS removes every zero from the encoded bytes, so the delimiter always
+ * marks a frame end and the receiver resynchronises on the next 0x00 after
+ * any error. The CRC is CRC-16/CCITT-FALSE (polynomial 0x1021, initial value
+ * 0xFFFF), sent high byte first.
+ *
+ * Received frames are decoded in place inside the RX ring (its mirror keeps
+ * every frame linear), so the application gets a pointer and a length and
+ * no byte is copied. Frames are encoded while they are written into the TX
+ * ring, looking ahead in the caller's buffer for the next zero instead of
+ * building an encoded copy.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef UART_FRAME_H
+#define UART_FRAME_H
+
+#include "UART.h"
+
+// USE_UART_FRAME is set in UART.h, which sizes the RX ring and its mirror for it
+
+// Largest payload accepted by UART_FrameReceive()
+#define UART_FRAME_MAX_PAYLOAD    16
+
+#define UART_FRAME_CRC_SIZE       2
+
+// Largest payload UART_FrameSend() encodes: with the CRC it fills one COBS block
+#define UART_FRAME_MAX_SEND       250
+#define UART_FRAME_DELIMITER      0x00
+
+// Payload and CRC plus one COBS code byte (payloads stay below 254 bytes), without the delimiter
+#define UART_FRAME_MAX_ENCODED    (UART_FRAME_MAX_PAYLOAD + UART_FRAME_CRC_SIZE + 1)
+
+#if USE_UART_FRAME
+#if !USE_UART_RX_BUFFER || !USE_UART_TX_BUFFER
+#error "UART framing needs USE_UART_RX_BUFFER and USE_UART_TX_BUFFER"
+#endif
+#if UART_FRAME_MAX_PAYLOAD > UART_FRAME_MAX_SEND
+#error "UART_FRAME_MAX_PAYLOAD must stay below one COBS block"
+#endif
+#if UART_RX_MIRROR_SIZE < UART_FRAME_MAX_ENCODED
+#error "UART_RX_MIRROR_SIZE must be at least UART_FRAME_MAX_ENCODED"
+#endif
+#if UART_RX_BUFFER_SIZE - 1 < UART_FRAME_MAX_ENCODED + 1
+#error "UART_RX_BUFFER_SIZE is too small to hold a whole frame"
+#endif
+
+/**
+ * @brief Get the next valid received frame.
+ *
+ * Releases the frame returned by the previous call, then looks for a
+ * delimiter in the RX ring. Frames that are too long, badly encoded or fail
+ * the CRC are dropped and counted. Never waits.
+ *
+ * The payload is decoded in place and stays valid until the next
+ * UART_FrameReceive() or UART_FrameRelease(). Release it early: while it is
+ * held, its bytes still occupy the RX ring.
+ *
+ * @param length Receives the payload length.
+ * @return Pointer to the payload, or 0 if no complete frame is waiting.
+ */
+unsigned char *UART_FrameReceive(unsigned char *length);
+
+/**
+ * @brief Release the frame returned by UART_FrameReceive().
+ */
+void UART_FrameRelease(void);
+
+/**
+ * @brief Encode and queue one frame.
+ *
+ * Waits only while the TX ring is full.
+ *
+ * @param data Payload.
+ * @param length Payload length, at most UART_FRAME_MAX_SEND.
+ * @return 1 if the frame was queued, 0 if it was too long and nothing was sent.
+ */
+unsigned char UART_FrameSend(const unsigned char *data, unsigned char length);
+
+/**
+ * @brief Get the number of dropped frames.
+ *
+ * @return Frames dropped for CRC, encoding or length errors since start-up,
+ *         saturating at 0xFFFF.
+ */
+unsigned int UART_FrameErrorCount(void);
+
+/**
+ * @brief Update a CRC-16/CCITT-FALSE with one byte.
+ *
+ * @param crc CRC so far, 0xFFFF to start.
+ * @param data Next byte.
+ * @return The updated CRC.
+ */
+unsigned int UART_FrameCrc(unsigned int crc, unsigned char data);
+
+#endif
+
+#endif // UART_FRAME_H
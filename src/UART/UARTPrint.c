@@ -0,0 +1,401 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file UARTPrint.c
+ * @brief Implementation of formatted text output over the UART without stdio.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include "UARTPrint.h"
+
+#if USE_UART_PRINT
+
+#if UART_PRINT_FORMAT
+#include <stdarg.h>
+#endif
+
+#define UART_PRINT_DIGITS       5  // Digits of 65535
+#define UART_PRINT_LONG_DIGITS  10 // Digits of 4294967295
+
+static const unsigned int uartPrintPowers[UART_PRINT_DIGITS] = {
+    10000, 1000, 100, 10, 1
+};
+
+#if UART_PRINT_LONG
+static const unsigned long uartPrintLongPowers[UART_PRINT_LONG_DIGITS] = {
+    1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+    10000UL, 1000UL, 100UL, 10UL, 1UL
+};
+#endif
+
+#if UART_PRINT_HEX
+static const char uartPrintHexDigits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+#endif
+
+/**
+ * @brief Print a string.
+ *
+ * @param text Zero-terminated string, in ROM or RAM.
+ */
+void UART_PrintString(const char *text)
+{
+    while (*text)
+    {
+        UART_Transmit(*text++);
+    }
+}
+
+/**
+ * @brief Print the digits of a value, with an optional decimal point.
+ *
+ * Each digit is the number of times its power of ten can be subtracted.
+ * Leading zeros are skipped down to the units digit of the integer part.
+ *
+ * @param value Value to print.
+ * @param decimals Digits after the point, 0 for none.
+ */
+static void UART_PrintDigits(unsigned int value, unsigned char decimals)
+{
+    unsigned int power;
+    unsigned char i;
+    unsigned char digit;
+    unsigned char started = 0;
+
+    for (i = 0; i < UART_PRINT_DIGITS; i++)
+    {
+        power = uartPrintPowers[i];
+        digit = '0';
+        while (value >= power)
+        {
+            value -= power;
+            digit++;
+        }
+
+        // Digit i stands for 10^(UART_PRINT_DIGITS - 1 - i)
+        if (digit != '0' || UART_PRINT_DIGITS - 1 - i <= decimals)
+        {
+            started = 1;
+        }
+        if (started)
+        {
+            if (decimals && UART_PRINT_DIGITS - i == decimals)
+            {
+                UART_Transmit('.');
+            }
+            UART_Transmit(digit);
+        }
+    }
+}
+
+/**
+ * @brief Print an unsigned integer in decimal.
+ *
+ * @param value Value to print, without leading zeros.
+ */
+void UART_PrintUnsigned(unsigned int value)
+{
+    UART_PrintDigits(value, 0);
+}
+
+#if UART_PRINT_SIGNED || UART_PRINT_DECIMAL || UART_PRINT_FIXED
+/**
+ * @brief Print the sign of a value and return its magnitude.
+ */
+static unsigned int UART_PrintSign(int value)
+{
+    if (value < 0)
+    {
+        UART_Transmit('-');
+        return 0 - (unsigned int)value; // Also right for -32768
+    }
+    return (unsigned int)value;
+}
+#endif
+
+#if UART_PRINT_SIGNED
+/**
+ * @brief Print a signed integer in decimal.
+ *
+ * @param value Value to print, with a '-' when negative.
+ */
+void UART_PrintSigned(int value)
+{
+    UART_PrintDigits(UART_PrintSign(value), 0);
+}
+#endif
+
+#if UART_PRINT_HEX
+/**
+ * @brief Print an unsigned integer in hexadecimal.
+ *
+ * @param value Value to print, upper case, without a 0x prefix.
+ * @param digits Number of digits 1..4, leading zeros included.
+ */
+void UART_PrintHex(unsigned int value, unsigned char digits)
+{
+    while (digits)
+    {
+        digits--;
+        UART_Transmit(uartPrintHexDigits[(value >> (digits << 2)) & 0x0F]);
+    }
+}
+#endif
+
+#if UART_PRINT_DECIMAL
+/**
+ * @brief Print a scaled integer with a decimal point.
+ *
+ * @param value Value in units of 10^-decimals.
+ * @param decimals Digits after the point, 0..4.
+ */
+void UART_PrintDecimal(int value, unsigned char decimals)
+{
+    UART_PrintDigits(UART_PrintSign(value), decimals);
+}
+#endif
+
+#if UART_PRINT_FIXED
+/**
+ * @brief Print a binary fixed-point number in decimal.
+ *
+ * Each fraction digit is the integer part of the remaining fraction times ten.
+ *
+ * @param value Signed value with fractionBits fraction bits.
+ * @param fractionBits Fraction bits, 1..UART_PRINT_MAX_FRACTION_BITS.
+ * @param decimals Digits after the point.
+ */
+void UART_PrintFixed(int value, unsigned char fractionBits, unsigned char decimals)
+{
+    unsigned int magnitude = UART_PrintSign(value);
+    unsigned int mask = (1U << fractionBits) - 1;
+    unsigned int fraction = magnitude & mask;
+
+    UART_PrintDigits(magnitude >> fractionBits, 0);
+    if (decimals)
+    {
+        UART_Transmit('.');
+    }
+    while (decimals--)
+    {
+        fraction = (fraction << 3) + (fraction << 1);
+        UART_Transmit((char)('0' + (fraction >> fractionBits)));
+        fraction &= mask;
+    }
+}
+#endif
+
+#if UART_PRINT_LONG
+/**
+ * @brief Print an unsigned 32-bit integer in decimal.
+ */
+void UART_PrintUnsignedLong(unsigned long value)
+{
+    unsigned long power;
+    unsigned char i;
+    unsigned char digit;
+    unsigned char started = 0;
+
+    for (i = 0; i < UART_PRINT_LONG_DIGITS; i++)
+    {
+        power = uartPrintLongPowers[i];
+        digit = '0';
+        while (value >= power)
+        {
+            value -= power;
+            digit++;
+        }
+        if (digit != '0' || i == UART_PRINT_LONG_DIGITS - 1)
+        {
+            started = 1;
+        }
+        if (started)
+        {
+            UART_Transmit(digit);
+        }
+    }
+}
+
+#if UART_PRINT_SIGNED
+/**
+ * @brief Print a signed 32-bit integer in decimal.
+ */
+void UART_PrintSignedLong(long value)
+{
+    if (value < 0)
+    {
+        UART_Transmit('-');
+        UART_PrintUnsignedLong(0 - (unsigned long)value);
+    }
+    else
+    {
+        UART_PrintUnsignedLong((unsigned long)value);
+    }
+}
+#endif
+#endif
+
+#if UART_PRINT_FORMAT
+#if UART_PRINT_HEX
+/**
+ * @brief Print a value in hexadecimal without leading zeros.
+ */
+static void UART_PrintHexShort(unsigned int value)
+{
+    unsigned char digits = 1;
+
+    while (digits < 4 && (value >> (digits << 2)) != 0)
+    {
+        digits++;
+    }
+    UART_PrintHex(value, digits);
+}
+#endif
+
+/**
+ * @brief Print a format string with its arguments.
+ *
+ * @param format Format string, in ROM or RAM.
+ */
+void UART_Printf(const char *format, ...)
+{
+    va_list arguments;
+    char c;
+#if UART_PRINT_LONG
+    unsigned char isLong;
+#if UART_PRINT_HEX
+    unsigned long value;
+#endif
+#endif
+
+    va_start(arguments, format);
+    while ((c = *format++) != 0)
+    {
+        if (c != '%')
+        {
+            UART_Transmit(c);
+            continue;
+        }
+
+        c = *format++;
+#if UART_PRINT_LONG
+        isLong = (c == 'l');
+        if (isLong)
+        {
+            c = *format++;
+        }
+        if (isLong)
+        {
+            switch (c)
+            {
+                case 'u':
+                    UART_PrintUnsignedLong(va_arg(arguments, unsigned long));
+                    continue;
+#if UART_PRINT_SIGNED
+                case 'd':
+                    UART_PrintSignedLong(va_arg(arguments, long));
+                    continue;
+#endif
+#if UART_PRINT_HEX
+                case 'x':
+                    value = va_arg(arguments, unsigned long);
+                    if (value >> 16)
+                    {
+                        UART_PrintHexShort((unsigned int)(value >> 16));
+                        UART_PrintHex((unsigned int)value, 4);
+                    }
+                    else
+                    {
+                        UART_PrintHexShort((unsigned int)value);
+                    }
+                    continue;
+#endif
+                default:
+                    // Printed as it is; a switched-off %ld or %lx still takes its argument
+                    if (c == 'd' || c == 'x')
+                    {
+                        (void)va_arg(arguments, unsigned long);
+                    }
+                    UART_Transmit('%');
+                    UART_Transmit('l');
+                    if (c == 0)
+                    {
+                        format--; // Lone "%l" at the end
+                        continue;
+                    }
+                    UART_Transmit(c);
+                    continue;
+            }
+        }
+#endif
+
+        switch (c)
+        {
+            case 's':
+                UART_PrintString(va_arg(arguments, const char *));
+                break;
+            case 'c':
+                UART_Transmit((char)va_arg(arguments, int));
+                break;
+            case 'u':
+                UART_PrintUnsigned(va_arg(arguments, unsigned int));
+                break;
+#if UART_PRINT_SIGNED
+            case 'd':
+                UART_PrintSigned(va_arg(arguments, int));
+                break;
+#endif
+#if UART_PRINT_HEX
+            case 'x':
+                UART_PrintHexShort(va_arg(arguments, unsigned int));
+                break;
+#endif
+#if !UART_PRINT_LONG
+            case 'l':
+                // Switched-off %lu, %ld and %lx print as they are but take their argument
+                UART_Transmit('%');
+                UART_Transmit('l');
+                c = *format++;
+                if (c == 'u' || c == 'd' || c == 'x')
+                {
+                    (void)va_arg(arguments, unsigned long);
+                }
+                if (c == 0)
+                {
+                    format--; // Lone "%l" at the end
+                    break;
+                }
+                UART_Transmit(c);
+                break;
+#endif
+            case 0:
+                format--; // Lone '%' at the end
+                break;
+            default:
+                // '%%' and conversions that are switched off print as they are;
+                // a switched-off %d or %x still takes its argument
+                if (c == 'd' || c == 'x')
+                {
+                    (void)va_arg(arguments, int);
+                }
+                if (c != '%')
+                {
+                    UART_Transmit('%');
+                }
+                UART_Transmit(c);
+                break;
+        }
+    }
+    va_end(arguments);
+}
+#endif
+
+#endif
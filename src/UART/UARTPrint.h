@@ -0,0 +1,140 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file UARTPrint.h
+ * @brief Header file for formatted text output over the UART without stdio.
+ *
+ * Every character goes straight to UART_Transmit(), nothing is formatted
+ * into a buffer first. Decimal digits are found by subtracting powers of
+ * ten from a ROM table (at most nine subtractions per digit), so no
+ * division or modulo routine is linked in; fixed-point fractions are
+ * produced by multiplying by ten with two shifts and an add.
+ *
+ * Each conversion has its own switch below. Switching off the ones a
+ * project does not use removes their code and tables, and UART_Printf()
+ * then prints unknown conversions literally.
+ *
+ * Strings are read through const pointers, so ROM strings print without
+ * being copied to RAM.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef UART_PRINT_H
+#define UART_PRINT_H
+
+#include "UART.h"
+
+// Enable or Disable the formatter
+#define USE_UART_PRINT            ENABLE
+
+// Conversions compiled in
+#define UART_PRINT_SIGNED         ENABLE  /**< UART_PrintSigned(), %d */
+#define UART_PRINT_HEX            ENABLE  /**< UART_PrintHex(), %x */
+#define UART_PRINT_DECIMAL        ENABLE  /**< UART_PrintDecimal(), scaled integers such as 0.1 C */
+#define UART_PRINT_FIXED          ENABLE  /**< UART_PrintFixed(), binary fixed point such as Q8.8 */
+#define UART_PRINT_LONG           DISABLE /**< 32-bit versions and the l modifier, %lu %ld %lx */
+#define UART_PRINT_FORMAT         ENABLE  /**< UART_Printf() */
+
+// Largest fraction size accepted by UART_PrintFixed(); fraction * 10 must fit 16 bits
+#define UART_PRINT_MAX_FRACTION_BITS  12
+
+#if USE_UART_PRINT
+
+/**
+ * @brief Print a string.
+ *
+ * @param text Zero-terminated string, in ROM or RAM.
+ */
+void UART_PrintString(const char *text);
+
+/**
+ * @brief Print an unsigned integer in decimal.
+ *
+ * @param value Value to print, without leading zeros.
+ */
+void UART_PrintUnsigned(unsigned int value);
+
+#if UART_PRINT_SIGNED
+/**
+ * @brief Print a signed integer in decimal.
+ *
+ * @param value Value to print, with a '-' when negative.
+ */
+void UART_PrintSigned(int value);
+#endif
+
+#if UART_PRINT_HEX
+/**
+ * @brief Print an unsigned integer in hexadecimal.
+ *
+ * @param value Value to print, upper case, without a 0x prefix.
+ * @param digits Number of digits 1..4, leading zeros included.
+ */
+void UART_PrintHex(unsigned int value, unsigned char digits);
+#endif
+
+#if UART_PRINT_DECIMAL
+/**
+ * @brief Print a scaled integer with a decimal point.
+ *
+ * UART_PrintDecimal(-53, 1) prints "-5.3", UART_PrintDecimal(7, 2) prints "0.07".
+ *
+ * @param value Value in units of 10^-decimals.
+ * @param decimals Digits after the point, 0..4.
+ */
+void UART_PrintDecimal(int value, unsigned char decimals);
+#endif
+
+#if UART_PRINT_FIXED
+/**
+ * @brief Print a binary fixed-point number in decimal.
+ *
+ * UART_PrintFixed(0x0180, 8, 2) prints a Q8.8 1.5 as "1.50". The fraction is
+ * truncated, not rounded.
+ *
+ * @param value Signed value with fractionBits fraction bits.
+ * @param fractionBits Fraction bits, 1..UART_PRINT_MAX_FRACTION_BITS.
+ * @param decimals Digits after the point.
+ */
+void UART_PrintFixed(int value, unsigned char fractionBits, unsigned char decimals);
+#endif
+
+#if UART_PRINT_LONG
+/**
+ * @brief Print an unsigned 32-bit integer in decimal.
+ */
+void UART_PrintUnsignedLong(unsigned long value);
+
+#if UART_PRINT_SIGNED
+/**
+ * @brief Print a signed 32-bit integer in decimal.
+ */
+void UART_PrintSignedLong(long value);
+#endif
+#endif
+
+#if UART_PRINT_FORMAT
+/**
+ * @brief Print a format string with its arguments.
+ *
+ * Understands %s, %c, %u and %% always, %d, %x (no leading zeros) and the l
+ * modifier when their conversions are enabled. A switched-off conversion is
+ * printed as it is but still takes its argument, so the ones after it stay in
+ * step. Flags, widths and precision are not supported; use the functions
+ * above for fixed widths and points.
+ *
+ * @param format Format string, in ROM or RAM.
+ */
+void UART_Printf(const char *format, ...);
+#endif
+
+#endif
+
+#endif // UART_PRINT_H
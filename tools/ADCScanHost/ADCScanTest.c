@@ -0,0 +1,313 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file ADCScanTest.c
+ * @brief Host test of the ADC scan sequencer against a simulated register file.
+ *
+ * The simulator plays the converter: it decodes the channel from SADC0/SADC1,
+ * loads SADOH/SADOL with that channel's input code in the data format set by
+ * the ADRFS bit of SADC0, and then calls ADCScanISR() as the end-of-conversion
+ * interrupt would. The tests step the sequencer through the configured
+ * channel list (ADCScan.h) and check the latest-value table, the sample ring
+ * (overrun and wraparound), oversampling decimation and that every channel
+ * switch waits for the channel's ADC_SETTLE_CYCLES_* before the conversion.
+ *
+ * Exits with 0 if every check passed.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include <stdio.h>
+
+#include "ADCScan.h"
+
+// Simulated register file
+volatile unsigned char _sadc0;
+volatile unsigned char _sadc1;
+volatile unsigned char _sadoh;
+volatile unsigned char _sadol;
+volatile unsigned char _adrfs;
+volatile unsigned char _adcen;
+volatile unsigned char _adbz;
+volatile unsigned char _ade;
+volatile unsigned char _adf;
+
+static volatile unsigned char hostStart;
+static unsigned long hostStartAccesses; // Three per ADC_START_CONVERSION pulse
+static unsigned long hostConversions;
+static unsigned int hostInput[ADC_NUMBER_OF_CHANNELS]; // 12-bit code of every channel
+static unsigned char hostDither[ADC_NUMBER_OF_CHANNELS]; // Add 1 to every other conversion
+static unsigned int hostDelayCycles;   // Delay since the last conversion started
+static unsigned int hostSettleCycles;  // Delay that preceded the last START pulse
+static unsigned int failures;
+
+static const unsigned char scanChannels[ADC_SCAN_NUMBER_OF_CHANNELS] = ADC_SCAN_CHANNELS;
+static const unsigned char settleCycles[ADC_NUMBER_OF_CHANNELS] = {
+    ADC_SETTLE_CYCLES_AN0, ADC_SETTLE_CYCLES_AN1, ADC_SETTLE_CYCLES_AN2, ADC_SETTLE_CYCLES_AN3,
+    ADC_SETTLE_CYCLES_VBGREF, ADC_SETTLE_CYCLES_OPA0O, ADC_SETTLE_CYCLES_OPA1O, ADC_SETTLE_CYCLES_LINEV
+};
+
+#define CHECK(condition, ...)                       \
+    do                                              \
+    {                                               \
+        if (!(condition))                           \
+        {                                           \
+            printf("FAIL line %d: ", __LINE__);     \
+            printf(__VA_ARGS__);                    \
+            printf("\n");                           \
+            failures++;                             \
+        }                                           \
+    } while (0)
+
+volatile unsigned char *HostStartBit(void)
+{
+    hostStartAccesses++;
+    if (hostDelayCycles)
+    {
+        hostSettleCycles = hostDelayCycles;
+        hostDelayCycles = 0;
+    }
+    return &hostStart;
+}
+
+void HostDelay(unsigned int cycles)
+{
+    hostDelayCycles += cycles;
+}
+
+/**
+ * @brief Decode the channel routed by SADC0/SADC1.
+ */
+static unsigned char HostChannel(void)
+{
+    unsigned char select = _sadc0 & 0x0F;
+
+    if (select < 4)
+    {
+        return select; // AN0..AN3
+    }
+    return 3 + (_sadc1 >> 5); // Internal source SAINS: VBGREF = 1 .. LINEV = 4
+}
+
+/**
+ * @brief Finish the conversion in progress and run the ADC interrupt.
+ */
+static void HostStep(void)
+{
+    unsigned long started = hostStartAccesses;
+    unsigned char channel = HostChannel();
+    unsigned int code = hostInput[channel];
+    unsigned char next;
+
+    CHECK(_adcen, "conversion %lu with the ADC off", hostConversions);
+    if (hostDither[channel] && (hostConversions & 1))
+    {
+        code++;
+    }
+    if (_sadc0 & 0x10)
+    {
+        _sadoh = (unsigned char)(code >> 8); // ADRFS = 1: right aligned
+        _sadol = (unsigned char)code;
+    }
+    else
+    {
+        _sadoh = (unsigned char)(code >> 4); // ADRFS = 0: left aligned
+        _sadol = (unsigned char)(code << 4);
+    }
+    hostConversions++;
+
+    hostSettleCycles = 0;
+    ADCScanISR();
+
+    if (ADCScanIsRunning())
+    {
+        CHECK(hostStartAccesses == started + 3, "ISR did not start the next conversion");
+        next = HostChannel();
+        if (next != channel)
+        {
+            CHECK(hostSettleCycles >= settleCycles[next], "channel %u sampled after %u settling cycles, needs %u",
+                  next, hostSettleCycles, settleCycles[next]);
+        }
+    }
+}
+
+/**
+ * @brief Value the sequencer should store for a channel.
+ */
+static unsigned int Expected(unsigned char channel)
+{
+    unsigned char bits = ADCOversampleBits[channel];
+    unsigned long count = ADC_OVERSAMPLE_COUNT(bits);
+    unsigned long sum = hostInput[channel] * count;
+
+    if (hostDither[channel])
+    {
+        sum += count / 2;
+    }
+    return (unsigned int)(sum >> bits);
+}
+
+/**
+ * @brief Run whole passes over the channel list.
+ */
+static void RunPasses(unsigned char passes)
+{
+    unsigned char start = ADCScanCycleCount;
+
+    while ((unsigned char)(ADCScanCycleCount - start) < passes)
+    {
+        HostStep();
+    }
+}
+
+/**
+ * @brief Take count samples and compare them with the channel list order.
+ */
+static void CheckSamples(unsigned char count, unsigned char firstIndex)
+{
+    ADCSample sample;
+    unsigned char i;
+    unsigned char channel;
+
+    for (i = 0; i < count; i++)
+    {
+        channel = scanChannels[(firstIndex + i) % ADC_SCAN_NUMBER_OF_CHANNELS];
+        CHECK(ADCScanGetSample(&sample), "sample %u missing", i);
+        CHECK(sample.channel == channel, "sample %u from channel %u, expected %u", i, sample.channel, channel);
+        CHECK(sample.value == Expected(channel), "sample %u value %u, expected %u", i, sample.value, Expected(channel));
+    }
+}
+
+static void TestLatestValues(void)
+{
+    unsigned char i;
+    unsigned char channel;
+
+    RunPasses(1);
+    CHECK(ADCScanCycleCount == 1, "cycle count %u", ADCScanCycleCount);
+    for (i = 0; i < ADC_SCAN_NUMBER_OF_CHANNELS; i++)
+    {
+        channel = scanChannels[i];
+        CHECK(ADCScanRead(channel) == Expected(channel), "channel %u latest %u, expected %u",
+              channel, ADCScanRead(channel), Expected(channel));
+    }
+    CHECK(ADCScanAvailable() == ADC_SCAN_NUMBER_OF_CHANNELS, "%u samples after one pass", ADCScanAvailable());
+    CheckSamples(ADC_SCAN_NUMBER_OF_CHANNELS, 0);
+}
+
+static void TestOversampling(void)
+{
+    unsigned long before = hostConversions;
+    unsigned long expected = 0;
+    unsigned char i;
+
+    for (i = 0; i < ADC_SCAN_NUMBER_OF_CHANNELS; i++)
+    {
+        expected += ADC_OVERSAMPLE_COUNT(ADCOversampleBits[scanChannels[i]]);
+    }
+    RunPasses(1);
+    CHECK(hostConversions - before == expected, "%lu conversions per pass, expected %lu",
+          hostConversions - before, expected);
+    CHECK(ADCScanRead(OPA1O) == 48008, "OPA1O decimated to %u, expected 48008", ADCScanRead(OPA1O));
+    CheckSamples(ADC_SCAN_NUMBER_OF_CHANNELS, 0);
+}
+
+static void TestOverrun(void)
+{
+    unsigned char dropped = 2 * ADC_SCAN_NUMBER_OF_CHANNELS - (ADC_SCAN_BUFFER_SIZE - 1);
+
+    // Two passes without reading: the ring holds SIZE - 1 samples, the rest is dropped
+    RunPasses(2);
+    CHECK(ADCScanAvailable() == ADC_SCAN_BUFFER_SIZE - 1, "%u samples in a full ring", ADCScanAvailable());
+    CHECK(ADCScanOverrunCount == dropped, "overrun count %u, expected %u", ADCScanOverrunCount, dropped);
+    CheckSamples(ADC_SCAN_BUFFER_SIZE - 1, 0);
+    CHECK(ADCScanAvailable() == 0, "ring not empty after draining");
+}
+
+static void TestWraparound(void)
+{
+    unsigned char overruns = ADCScanOverrunCount;
+    unsigned char pass;
+
+    // Head and tail go round the ring several times
+    for (pass = 0; pass < 7; pass++)
+    {
+        RunPasses(1);
+        CheckSamples(ADC_SCAN_NUMBER_OF_CHANNELS, 0);
+    }
+    CHECK(ADCScanOverrunCount == overruns, "overrun while drained");
+}
+
+static void TestInterruptMask(void)
+{
+    _ade = 0;
+    ADCScanRead(AN0);
+    CHECK(_ade == 0, "ADCScanRead enabled the ADC interrupt");
+    ADCWindowGetEvents();
+    CHECK(_ade == 0, "ADCWindowGetEvents enabled the ADC interrupt");
+    _ade = 1;
+    ADCScanRead(AN0);
+    CHECK(_ade == 1, "ADCScanRead left the ADC interrupt off");
+}
+
+static void TestStop(void)
+{
+    unsigned long started;
+
+    ADCScanStop();
+    CHECK(!_adcen, "ADC still powered after ADCScanStop");
+    started = hostStartAccesses;
+    _adcen = 1; // A conversion that was already running finishes
+    HostStep();
+    CHECK(hostStartAccesses == started, "conversion started after ADCScanStop");
+}
+
+static void TestOwnership(void)
+{
+    unsigned long started;
+
+    CHECK(!ADCInterruptBusy(), "ADC still owned after ADCScanStop");
+    CHECK(ADCInterruptClaim(), "ADC not free after ADCScanStop"); // As the timer trigger would
+    started = hostStartAccesses;
+    CHECK(!ADCScanStart(), "scan started while the trigger owns the ADC");
+    CHECK(hostStartAccesses == started, "conversion started while the trigger owns the ADC");
+    ADCInterruptRelease();
+    CHECK(ADCScanStart(), "scan refused with the ADC free");
+    CHECK(ADCInterruptBusy(), "running scan does not own the ADC");
+    ADCScanStop();
+}
+
+int main(void)
+{
+    hostInput[AN0] = 1000;
+    hostInput[AN1] = 2000;
+    hostInput[VBGREF] = 1234;
+    hostInput[OPA1O] = 3000;
+    hostDither[OPA1O] = 1; // 128 x 3000 + 128 x 3001, decimated by 16: 48008
+    hostInput[LINEV] = 4095;
+
+    ADCInit();
+    ADCScanInit();
+    CHECK(_ade == 1, "ADCScanInit did not enable the ADC interrupt");
+    CHECK(ADCScanStart(), "ADCScanStart refused to start");
+    CHECK(hostStartAccesses == 3, "ADCScanStart did not start a conversion");
+    CHECK(hostSettleCycles >= 12 + settleCycles[scanChannels[0]], "first channel sampled after %u cycles",
+          hostSettleCycles);
+
+    TestLatestValues();
+    TestOversampling();
+    TestOverrun();
+    TestWraparound();
+    TestInterruptMask();
+    TestStop();
+    TestOwnership();
+
+    printf("%s: %lu conversions, %u failures\n", failures ? "FAIL" : "PASS", hostConversions, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,41 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file BA45F5240.h
+ * @brief Host stand-in for the Holtek device header with a simulated ADC register file.
+ *
+ * Every register and bit used by ADC.c and ADCScan.c is a plain byte defined
+ * in ADCScanTest.c. START is reached through HostStartBit(), so the test can
+ * count the conversions the code starts, and GCC_DELAY() through HostDelay().
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef BA45F5240_HOST_H
+#define BA45F5240_HOST_H
+
+extern volatile unsigned char _sadc0;
+extern volatile unsigned char _sadc1;
+extern volatile unsigned char _sadoh;
+extern volatile unsigned char _sadol;
+extern volatile unsigned char _adrfs;
+extern volatile unsigned char _adcen;
+extern volatile unsigned char _adbz;
+extern volatile unsigned char _ade;
+extern volatile unsigned char _adf;
+
+// Every access to START goes through the simulator
+volatile unsigned char *HostStartBit(void);
+#define _start  (*HostStartBit())
+
+// Delays are counted so the test can check the settling time before a conversion
+void HostDelay(unsigned int cycles);
+#define GCC_DELAY(cycles)  HostDelay(cycles)
+
+#endif // BA45F5240_HOST_H
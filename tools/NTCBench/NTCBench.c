@@ -0,0 +1,158 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file NTCBench.c
+ * @brief Host accuracy and throughput benchmark for one NTC.c configuration.
+ *
+ * The Makefile builds NTC.c once per TEMPERATURE_CALCULATION_METHOD /
+ * CALCULATE_STENINHART_LOGARITM_LIBRARY / NTC_TABLE_STEP_BITS combination and
+ * links it with this file. Every ADC code is converted with temperature() and
+ * compared against the Steinhart-Hart equation evaluated in double precision
+ * at the exact divider resistance. Only codes whose reference lies inside
+ * REF_MIN_C..REF_MAX_C are scored. One JSON object is printed per run, with
+ * the reference model and the scored code and temperature range, so the Beta
+ * backend's figure reads as its distance from Steinhart-Hart.
+ *
+ * Throughput and object size are host figures: use them to rank the
+ * backends against each other, not as HT8 cycle counts.
+ *
+ * Usage: bench <object size in bytes>
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "NTC.h"
+
+#ifndef BENCH_NAME
+#define BENCH_NAME "unknown"
+#endif
+
+// Reference model, the same part NTC.h and NTCTable.h are configured for
+#define REF_A          0.001277368779
+#define REF_B          0.0002082232310
+#define REF_C          0.0000002032989311
+#define REF_MIN_C      (-40.0) // Codes whose reference lies outside are not scored
+#define REF_MAX_C      125.0
+#define REF_MODEL      "steinhart_hart"
+
+#define ADC_CODES      (ADC_FULL_SCALE + 1)
+#define BENCH_SECONDS  0.2
+
+/**
+ * @brief Reference temperature of an ADC code.
+ *
+ * @param code ADC code.
+ * @return Temperature in degC, or NAN when the divider is open or shorted.
+ */
+static double ReferenceTemperature(unsigned int code)
+{
+    double ratio = code / (double)ADCNumerOfBits;
+    double fixed = NTC_FIXED_RESISTOR_OHMS;
+    double resistance;
+    double logR;
+
+    if (code == 0 || code >= (unsigned int)ADCNumerOfBits)
+    {
+        return NAN;
+    }
+
+#if NTC_TOPOLOGY == NTC_IS_PULLDOWN
+    resistance = ratio / (1.0 - ratio) * fixed;
+#else
+    resistance = (1.0 - ratio) / ratio * fixed;
+#endif
+    logR = log(resistance);
+    return 1.0 / (REF_A + REF_B * logR + REF_C * logR * logR * logR) - 273.15;
+}
+
+/**
+ * @brief Seconds from a monotonic clock.
+ */
+static double Now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    volatile float sink = 0.0f;
+    double maxError = 0.0;
+    double sumError = 0.0;
+    double start;
+    double elapsed;
+    unsigned long conversions = 0;
+    unsigned int scored = 0;
+    unsigned int invalid = 0;
+    unsigned int firstCode = ADC_CODES;
+    unsigned int lastCode = 0;
+    unsigned int code;
+    long objectSize = (argc > 1) ? atol(argv[1]) : -1;
+
+    // Accuracy over every ADC code
+    for (code = 0; code < ADC_CODES; code++)
+    {
+        double reference = ReferenceTemperature(code);
+        double value;
+        double error;
+
+        if (isnan(reference) || reference < REF_MIN_C || reference > REF_MAX_C)
+        {
+            continue;
+        }
+        if (code < firstCode)
+        {
+            firstCode = code;
+        }
+        lastCode = code;
+
+        value = temperature(code, 3.3f);
+        if (value <= -999.0 || !isfinite(value))
+        {
+            invalid++; // Backend reports out of range where the reference does not
+            continue;
+        }
+
+        error = fabs(value - reference);
+        if (error > maxError)
+        {
+            maxError = error;
+        }
+        sumError += error;
+        scored++;
+    }
+
+    // Throughput: sweep all codes until BENCH_SECONDS have passed
+    start = Now();
+    do
+    {
+        for (code = 0; code < ADC_CODES; code++)
+        {
+            sink = temperature(code, 3.3f);
+        }
+        conversions += ADC_CODES;
+        elapsed = Now() - start;
+    } while (elapsed < BENCH_SECONDS);
+    (void)sink;
+
+    printf("{\"variant\":\"%s\",\"method\":%d,\"log\":%d,\"reference\":\"%s\","
+           "\"scored_range_c\":[%.0f,%.0f],\"scored_code_range\":[%u,%u],\"scored_codes\":%u,\"invalid_codes\":%u,"
+           "\"max_error_c\":%.4f,\"mean_error_c\":%.4f,\"conversions_per_s\":%.0f,\"object_bytes\":%ld}\n",
+           BENCH_NAME, TEMPERATURE_CALCULATION_METHOD, CALCULATE_STENINHART_LOGARITM_LIBRARY, REF_MODEL,
+           REF_MIN_C, REF_MAX_C, firstCode, lastCode, scored, invalid, maxError, scored ? sumError / scored : 0.0,
+           conversions / elapsed, objectSize);
+    return 0;
+}
@@ -0,0 +1,22 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file BA45F5240.h
+ * @brief Host stand-in for the Holtek device header.
+ *
+ * NTC.c only uses the device header through macros it does not expand
+ * (NTC_POWER_ON/OFF), so the host benchmark needs no register definitions.
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#ifndef BA45F5240_HOST_H
+#define BA45F5240_HOST_H
+
+#endif // BA45F5240_HOST_H
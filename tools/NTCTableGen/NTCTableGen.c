@@ -0,0 +1,689 @@
+/*
+ * Licensed under the Apache License, Version 2.0.
+ * You may not use this file except in compliance with the License.
+ * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.
+ * Distributed on an "AS IS" basis, without warranties or conditions.
+ */
+
+/**
+ * @file NTCTableGen.c
+ * @brief Host tool that generates src/NTC/NTCTable.h and NTCBreakpoints.h.
+ *
+ * The NTC configuration is read from NTC.h: the Steinhart-Hart coefficients
+ * A, B and C, NTC_FIXED_RESISTOR (kOhm), NTC_TOPOLOGY and ADCNumerOfBits,
+ * which NTC.h takes from ADC_FULL_SCALE in ADC.h.
+ * A Beta/R25 model can be used instead with --beta and --r25.
+ *
+ * For every candidate step (2^4..2^7 ADC codes per entry) the tool builds the
+ * table exactly as the firmware stores it, interpolates every ADC code the
+ * same way GetTemperatureFromCode() does and reports the worst error against
+ * the double-precision model together with the ROM size. The header holds
+ * every candidate, or with --max-error only the coarsest step inside the budget,
+ * and defines NTC_TABLE_STEP_BITS unless the build already does.
+ *
+ * The number of ADC codes follows ADCNumerOfBits (4094 and 4095 are 12 bits,
+ * 1023 is 10 bits, 255 is 8 bits); --bits overrides it.
+ *
+ * With --pwl the tool writes NTCBreakpoints.h instead: the fewest
+ * piecewise-linear segments that keep every code inside the given error,
+ * evaluated the same way GetTemperatureFromBreakpoints() does.
+ *
+ * Usage:
+ *   NTCTableGen [-i NTC.h] [-a ADC.h] [-o NTCTable.h] [--beta B --r25 ohm]
+ *               [--max-error degC | --pwl degC] [--min decidegC] [--max decidegC]
+ *               [--bits 8..16]
+ *
+ * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi
+ * Date: 2024
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STEP_BITS_FIRST  4
+#define STEP_BITS_LAST   7
+#define STEP_BITS_DEFAULT 6   // Step the header selects when it holds every candidate
+#define ADC_BITS_MIN     8
+#define ADC_BITS_MAX     16
+#define LINE_LENGTH      256
+#define MACRO_DEPTH_MAX  4    // Macro names followed to reach a number
+
+/** @brief NTC model and divider read from NTC.h and the command line. */
+typedef struct
+{
+    double a, b, c;        /**< Steinhart-Hart coefficients (ohm) */
+    double beta;           /**< Beta value, used when non-zero */
+    double r25;            /**< Resistance at 25 degC for the Beta model (ohm) */
+    double fixedKOhm;      /**< NTC_FIXED_RESISTOR as written in NTC.h */
+    int pullUp;            /**< 1 for NTC_IS_PULLUP, 0 for NTC_IS_PULLDOWN */
+    double fullScale;      /**< ADCNumerOfBits */
+    int codes;             /**< Number of ADC codes, 2^bits */
+    int minDeci;           /**< Clamp limits in 0.1 degC */
+    int maxDeci;
+} NTCModel;
+
+/** @brief One candidate table. */
+typedef struct
+{
+    int stepBits;
+    int size;
+    int maxDelta;
+    double maxError;       /**< degC, over codes inside the clamp range */
+    int *values;           /**< size entries */
+} NTCTable;
+
+/** @brief One piecewise-linear breakpoint, as NTCBreakpoint in NTC.h. */
+typedef struct
+{
+    int code;
+    int temperature;
+    int slope;
+} NTCBreakpoint;
+
+/**
+ * @brief Find "#define name value" in a header.
+ *
+ * @param path Path of the header.
+ * @param name Macro name.
+ * @param value Buffer for the first token of the value.
+ * @param size Size of the buffer.
+ * @return 1 if found, 0 otherwise.
+ */
+static int FindDefine(const char *path, const char *name, char *value, size_t size)
+{
+    char line[LINE_LENGTH];
+    char fmt[32];
+    FILE *file = fopen(path, "r");
+
+    if (!file)
+    {
+        return 0;
+    }
+    snprintf(fmt, sizeof(fmt), "%%%ds", (int)size - 1);
+
+    while (fgets(line, sizeof(line), file))
+    {
+        char *p = line;
+        size_t length = strlen(name);
+
+        while (*p == ' ' || *p == '\t') p++;
+        if (strncmp(p, "#define", 7) != 0) continue;
+        p += 7;
+        while (*p == ' ' || *p == '\t') p++;
+        if (strncmp(p, name, length) != 0 || (p[length] != ' ' && p[length] != '\t')) continue;
+
+        if (sscanf(p + length, fmt, value) == 1)
+        {
+            fclose(file);
+            return 1;
+        }
+    }
+
+    fclose(file);
+    return 0;
+}
+
+/**
+ * @brief Read a numeric macro, following macro indirection.
+ *
+ * Names not defined in NTC.h are looked up in ADC.h, which holds the shared
+ * ADC_FULL_SCALE.
+ *
+ * @param path Path of NTC.h.
+ * @param adcPath Path of ADC.h.
+ * @param name Macro name.
+ * @param result Where to store the value.
+ * @return 1 if found, 0 otherwise.
+ */
+static int ReadNumber(const char *path, const char *adcPath, const char *name, double *result)
+{
+    char value[64];
+    char target[64];
+    char *end;
+    int depth;
+
+    snprintf(target, sizeof(target), "%s", name);
+    for (depth = 0; depth < MACRO_DEPTH_MAX; depth++)
+    {
+        if (!FindDefine(path, target, value, sizeof(value)) &&
+            !FindDefine(adcPath, target, value, sizeof(value)))
+        {
+            return 0;
+        }
+
+        *result = strtod(value, &end);
+        if (end != value)
+        {
+            return 1;
+        }
+        snprintf(target, sizeof(target), "%s", value);
+    }
+    return 0;
+}
+
+/**
+ * @brief NTC resistance for an ADC code.
+ *
+ * @param model The NTC model.
+ * @param code ADC code, 0 < code < full scale.
+ * @return Resistance in ohms.
+ */
+static double Resistance(const NTCModel *model, double code)
+{
+    double ratio = code / model->fullScale;
+    double fixed = model->fixedKOhm * 1000.0;
+
+    return model->pullUp ? (1.0 - ratio) / ratio * fixed : ratio / (1.0 - ratio) * fixed;
+}
+
+/**
+ * @brief Exact temperature for an ADC code, before rounding and clamping.
+ *
+ * @param model The NTC model.
+ * @param code ADC code.
+ * @return Temperature in degC (+-HUGE_VAL at the ends of the range).
+ */
+static double Temperature(const NTCModel *model, double code)
+{
+    double logR;
+
+    if (code <= 0.0)
+    {
+        return model->pullUp ? -HUGE_VAL : HUGE_VAL;
+    }
+    if (code >= model->fullScale)
+    {
+        return model->pullUp ? HUGE_VAL : -HUGE_VAL;
+    }
+
+    logR = log(Resistance(model, code));
+    if (model->beta != 0.0)
+    {
+        return 1.0 / (1.0 / 298.15 + (logR - log(model->r25)) / model->beta) - 273.15;
+    }
+    return 1.0 / (model->a + model->b * logR + model->c * logR * logR * logR) - 273.15;
+}
+
+/**
+ * @brief Table entry for an ADC code: 0.1 degC, rounded and clamped.
+ */
+static int Entry(const NTCModel *model, int code)
+{
+    double t = Temperature(model, code);
+
+    if (t * 10.0 >= model->maxDeci) return model->maxDeci;
+    if (t * 10.0 <= model->minDeci) return model->minDeci;
+    return (int)floor(t * 10.0 + 0.5);
+}
+
+/**
+ * @brief Interpolate like GetTemperatureFromCode() in NTC.c.
+ */
+static int Interpolate(const NTCTable *table, int code)
+{
+    int index = code >> table->stepBits;
+    unsigned int fraction = code & ((1 << table->stepBits) - 1);
+    int low = table->values[index];
+    int high = table->values[index + 1];
+
+    if (high < low)
+    {
+        return low - (int)(((unsigned int)(low - high) * fraction) >> table->stepBits);
+    }
+    return low + (int)(((unsigned int)(high - low) * fraction) >> table->stepBits);
+}
+
+/**
+ * @brief Build one candidate table and measure its error.
+ */
+static void BuildTable(const NTCModel *model, int stepBits, NTCTable *table)
+{
+    int i;
+    int code;
+
+    table->stepBits = stepBits;
+    table->size = (model->codes >> stepBits) + 1;
+    table->maxDelta = 0;
+    table->maxError = 0.0;
+    table->values = malloc(table->size * sizeof(int));
+    if (!table->values)
+    {
+        perror("NTCTableGen");
+        exit(1);
+    }
+
+    for (i = 0; i < table->size; i++)
+    {
+        table->values[i] = Entry(model, i << stepBits);
+        if (i > 0 && abs(table->values[i] - table->values[i - 1]) > table->maxDelta)
+        {
+            table->maxDelta = abs(table->values[i] - table->values[i - 1]);
+        }
+    }
+
+    for (code = 0; code < model->codes; code++)
+    {
+        double exact = Temperature(model, code);
+        double error;
+
+        if (exact * 10.0 < model->minDeci || exact * 10.0 > model->maxDeci)
+        {
+            continue; // Clamped on purpose
+        }
+        error = fabs(Interpolate(table, code) / 10.0 - exact);
+        if (error > table->maxError)
+        {
+            table->maxError = error;
+        }
+    }
+}
+
+/**
+ * @brief Write the license, file comment and generation parameters.
+ *
+ * @param out Output file.
+ * @param model The NTC model.
+ * @param file File name for @file.
+ * @param description Lines of the file description, each starting with " * ".
+ */
+static void WriteBanner(FILE *out, const NTCModel *model, const char *file, const char *description)
+{
+    fprintf(out,
+        "/*\n"
+        " * Licensed under the Apache License, Version 2.0.\n"
+        " * You may not use this file except in compliance with the License.\n"
+        " * Obtain a copy at http://www.apache.org/licenses/LICENSE-2.0.\n"
+        " * Distributed on an \"AS IS\" basis, without warranties or conditions.\n"
+        " */\n\n"
+        "/**\n"
+        " * @file %s\n"
+        "%s"
+        " *\n"
+        " * Generated from:\n", file, description);
+    if (model->beta != 0.0)
+    {
+        fprintf(out, " *   Beta = %.6g, R25 = %.6g ohm\n", model->beta, model->r25);
+    }
+    else
+    {
+        fprintf(out, " *   A = %.10g, B = %.10g, C = %.10g\n", model->a, model->b, model->c);
+    }
+    fprintf(out,
+        " *   Fixed resistor = %.6g ohm, %s, full scale = %.6g\n"
+        " *\n"
+        " * Author: Mohamad Khosravi  https://github.com/Mohamadkhosravi\n"
+        " * Date: 2024\n"
+        " */\n\n",
+        model->fixedKOhm * 1000.0, model->pullUp ? "NTC_IS_PULLUP" : "NTC_IS_PULLDOWN", model->fullScale);
+}
+
+/**
+ * @brief Write the header in the format NTC.c expects.
+ *
+ * @param stepBits Step the header defines when NTC_TABLE_STEP_BITS is not set.
+ */
+static void WriteHeader(FILE *out, const NTCModel *model, const NTCTable *tables, int count, int stepBits)
+{
+    char description[512];
+    int t;
+    int i;
+
+    snprintf(description, sizeof(description),
+        " * @brief ADC code to temperature table for the USE_CODE_TABLE backend.\n"
+        " *\n"
+        " * Temperatures are in 0.1 degC, one entry every 2^NTC_TABLE_STEP_BITS codes\n"
+        " * from code 0 up to and including code %d, clamped to\n"
+        " * NTC_TABLE_MIN..NTC_TABLE_MAX. Do not edit; regenerate with\n"
+        " * tools/NTCTableGen after changing the coefficients or the divider in NTC.h.\n",
+        model->codes);
+    WriteBanner(out, model, "NTCTable.h", description);
+    fprintf(out,
+        "#ifndef NTC_TABLE_H\n"
+        "#define NTC_TABLE_H\n\n"
+        "// Divider the table was generated for, checked against NTC.h\n"
+        "#define NTC_TABLE_FIXED_RESISTOR  %.6g\n"
+        "#define NTC_TABLE_TOPOLOGY        %s\n\n"
+        "// Clamp limits in 0.1 degC\n"
+        "#define NTC_TABLE_MIN  (%d)\n"
+        "#define NTC_TABLE_MAX  %d\n\n"
+        "// Highest ADC code, ADCNumerOfBits rounded up to whole bits\n"
+        "#define NTC_TABLE_MAX_CODE  %d\n\n"
+        "// Step used unless NTC.h or the build sets NTC_TABLE_STEP_BITS\n"
+        "#ifndef NTC_TABLE_STEP_BITS\n"
+        "#define NTC_TABLE_STEP_BITS  %d\n"
+        "#endif\n\n",
+        model->fixedKOhm, model->pullUp ? "NTC_IS_PULLUP" : "NTC_IS_PULLDOWN",
+        model->minDeci, model->maxDeci, model->codes - 1, stepBits);
+
+    for (t = 0; t < count; t++)
+    {
+        const NTCTable *table = &tables[t];
+
+        fprintf(out, "%s NTC_TABLE_STEP_BITS == %d\n", t ? "#elif" : "#if", table->stepBits);
+        fprintf(out, "#define NTC_TABLE_SIZE       %d\n", table->size);
+        fprintf(out, "#define NTC_TABLE_MAX_DELTA  %d\n", table->maxDelta);
+        fprintf(out, "static const int ntcCodeTable[NTC_TABLE_SIZE] = {\n");
+        for (i = 0; i < table->size; i++)
+        {
+            fprintf(out, "%s%5d%s", (i % 12) ? " " : "    ", table->values[i],
+                    (i + 1 == table->size) ? "\n" : ((i % 12 == 11) ? ",\n" : ","));
+        }
+        fprintf(out, "};\n");
+    }
+
+    fprintf(out,
+        "#else\n"
+        "#error \"NTCTable.h has no table for this NTC_TABLE_STEP_BITS (%d..%d)\"\n"
+        "#endif\n\n"
+        "#endif // NTC_TABLE_H\n",
+        tables[0].stepBits, tables[count - 1].stepBits);
+}
+
+/**
+ * @brief Exact temperature of a code in 0.1 degC, clamped but not rounded.
+ */
+static double ExactDeci(const NTCModel *model, int code)
+{
+    double t = Temperature(model, code) * 10.0;
+
+    if (t > model->maxDeci) return model->maxDeci;
+    if (t < model->minDeci) return model->minDeci;
+    return t;
+}
+
+/**
+ * @brief Evaluate a segment like GetTemperatureFromBreakpoints() in NTC.c.
+ */
+static int SegmentValue(const NTCBreakpoint *breakpoint, int code)
+{
+    long delta = (long)breakpoint->slope * (code - breakpoint->code);
+
+    return breakpoint->temperature + (int)((delta >= 0) ? (delta >> 8) : -((-delta) >> 8));
+}
+
+/**
+ * @brief Choose piecewise-linear breakpoints for an error bound.
+ *
+ * Greedy: every segment is stretched until one code between its ends would
+ * be off by more than the bound, using the rounded Q8 slope the firmware uses.
+ *
+ * @param model The NTC model.
+ * @param boundDeci Error bound in 0.1 degC.
+ * @param breakpoints Output array of model->codes entries.
+ * @param maxError Worst error in degC of the chosen breakpoints.
+ * @return The number of breakpoints.
+ */
+static int BuildBreakpoints(const NTCModel *model, double boundDeci, NTCBreakpoint *breakpoints, double *maxError)
+{
+    int count = 0;
+    int start = 0;
+
+    *maxError = 0.0;
+    while (start < model->codes - 1)
+    {
+        NTCBreakpoint best;
+        double bestError = 0.0;
+        int end;
+
+        for (end = start + 1; end < model->codes; end++)
+        {
+            NTCBreakpoint candidate;
+            double worst = 0.0;
+            int code;
+
+            candidate.code = start;
+            candidate.temperature = Entry(model, start);
+            candidate.slope = (int)floor((Entry(model, end) - candidate.temperature) * 256.0 / (end - start) + 0.5);
+
+            for (code = start; code <= end; code++)
+            {
+                double error = fabs(SegmentValue(&candidate, code) - ExactDeci(model, code));
+                if (error > worst) worst = error;
+            }
+            if (worst > boundDeci && end > start + 1)
+            {
+                break;
+            }
+            best = candidate;
+            bestError = worst;
+            if (worst > boundDeci)
+            {
+                end++; // A single-code segment is kept even above the bound
+                break;
+            }
+        }
+
+        breakpoints[count++] = best;
+        if (bestError / 10.0 > *maxError)
+        {
+            *maxError = bestError / 10.0;
+        }
+        start = end - 1;
+    }
+    return count;
+}
+
+/**
+ * @brief Write the breakpoint header in the format NTC.c expects.
+ */
+static void WriteBreakpoints(FILE *out, const NTCModel *model, const NTCBreakpoint *breakpoints, int count, double bound)
+{
+    char description[512];
+    int i;
+
+    snprintf(description, sizeof(description),
+        " * @brief Piecewise-linear breakpoints for the USE_PIECEWISE_LINEAR backend.\n"
+        " *\n"
+        " * Each breakpoint starts a segment at an ADC code with its temperature in\n"
+        " * 0.1 degC and a slope in 0.1 degC / 256 per code. Spacing follows the\n"
+        " * curvature, so every code stays within %.2f degC of the model (clamped\n"
+        " * to %d..%d). Do not edit; regenerate with tools/NTCTableGen.\n",
+        bound, model->minDeci, model->maxDeci);
+    WriteBanner(out, model, "NTCBreakpoints.h", description);
+
+    fprintf(out,
+        "#ifndef NTC_BREAKPOINTS_H\n"
+        "#define NTC_BREAKPOINTS_H\n\n"
+        "// Divider the breakpoints were generated for, checked against NTC.h\n"
+        "#define NTC_BREAKPOINTS_FIXED_RESISTOR  %.6g\n"
+        "#define NTC_BREAKPOINTS_TOPOLOGY        %s\n\n"
+        "// Highest ADC code, ADCNumerOfBits rounded up to whole bits\n"
+        "#define NTC_BREAKPOINTS_MAX_CODE  %d\n\n"
+        "#define NTC_BREAKPOINT_COUNT  %d\n"
+        "static const NTCBreakpoint ntcBreakpoints[NTC_BREAKPOINT_COUNT] = {\n",
+        model->fixedKOhm, model->pullUp ? "NTC_IS_PULLUP" : "NTC_IS_PULLDOWN", model->codes - 1, count);
+    for (i = 0; i < count; i++)
+    {
+        fprintf(out, "    { %4d, %5d, %5d }%s\n", breakpoints[i].code, breakpoints[i].temperature,
+                breakpoints[i].slope, (i + 1 == count) ? "" : ",");
+    }
+    fprintf(out, "};\n\n#endif // NTC_BREAKPOINTS_H\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *input = "../../src/NTC/NTC.h";
+    const char *adcHeader = "../../src/ADC/ADC.h";
+    const char *output = NULL;
+    double maxError = 0.0;
+    double pwlError = 0.0;
+    double topology = 0.0;
+    double pullUpValue = 1.0;
+    int bits = 0;
+    int stepBits;
+    NTCModel model;
+    NTCTable tables[STEP_BITS_LAST - STEP_BITS_FIRST + 1];
+    int count = 0;
+    int first = 0;
+    int i;
+    char value[64];
+    FILE *out;
+
+    memset(&model, 0, sizeof(model));
+    model.minDeci = -400;
+    model.maxDeci = 1250;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-i") && i + 1 < argc) input = argv[++i];
+        else if (!strcmp(argv[i], "-a") && i + 1 < argc) adcHeader = argv[++i];
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc) output = argv[++i];
+        else if (!strcmp(argv[i], "--beta") && i + 1 < argc) model.beta = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--r25") && i + 1 < argc) model.r25 = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--max-error") && i + 1 < argc) maxError = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--pwl") && i + 1 < argc) pwlError = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--min") && i + 1 < argc) model.minDeci = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--max") && i + 1 < argc) model.maxDeci = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--bits") && i + 1 < argc) bits = atoi(argv[++i]);
+        else
+        {
+            fprintf(stderr, "usage: %s [-i NTC.h] [-a ADC.h] [-o NTCTable.h] [--beta B --r25 ohm]\n"
+                            "       [--max-error degC | --pwl degC] [--min decidegC] [--max decidegC]\n"
+                            "       [--bits %d..%d]\n", argv[0], ADC_BITS_MIN, ADC_BITS_MAX);
+            return 2;
+        }
+    }
+
+    if (!ReadNumber(input, adcHeader, "NTC_FIXED_RESISTOR", &model.fixedKOhm) ||
+        !ReadNumber(input, adcHeader, "ADCNumerOfBits", &model.fullScale) ||
+        !FindDefine(input, "NTC_TOPOLOGY", value, sizeof(value)))
+    {
+        fprintf(stderr, "%s: NTC_FIXED_RESISTOR, ADCNumerOfBits or NTC_TOPOLOGY not found\n", input);
+        return 1;
+    }
+    if (!ReadNumber(input, adcHeader, value, &topology) ||
+        !ReadNumber(input, adcHeader, "NTC_IS_PULLUP", &pullUpValue))
+    {
+        fprintf(stderr, "%s: unknown NTC_TOPOLOGY %s\n", input, value);
+        return 1;
+    }
+    model.pullUp = (topology == pullUpValue);
+
+    // Whole bits that hold the full-scale code, unless given
+    if (bits == 0)
+    {
+        for (bits = ADC_BITS_MIN; bits < ADC_BITS_MAX && (1 << bits) <= model.fullScale; bits++)
+        {
+        }
+    }
+    if (bits < ADC_BITS_MIN || bits > ADC_BITS_MAX || model.fullScale >= (1 << bits))
+    {
+        fprintf(stderr, "ADCNumerOfBits %.6g does not fit %d bits (%d..%d)\n",
+                model.fullScale, bits, ADC_BITS_MIN, ADC_BITS_MAX);
+        return 2;
+    }
+    model.codes = 1 << bits;
+
+    if (model.beta != 0.0)
+    {
+        if (model.r25 <= 0.0)
+        {
+            fprintf(stderr, "--beta needs --r25\n");
+            return 2;
+        }
+    }
+    else if (!ReadNumber(input, adcHeader, "A", &model.a) || !ReadNumber(input, adcHeader, "B", &model.b) ||
+             !ReadNumber(input, adcHeader, "C", &model.c))
+    {
+        fprintf(stderr, "%s: Steinhart-Hart coefficients A, B, C not found\n", input);
+        return 1;
+    }
+
+    // Piecewise-linear breakpoints instead of a code table
+    if (pwlError > 0.0)
+    {
+        NTCBreakpoint *breakpoints = malloc(model.codes * sizeof(NTCBreakpoint));
+        double pwlMaxError;
+
+        if (!breakpoints)
+        {
+            perror("NTCTableGen");
+            return 1;
+        }
+        count = BuildBreakpoints(&model, pwlError * 10.0, breakpoints, &pwlMaxError);
+        printf("breakpoints  ROM bytes  max error (degC)\n%11d  %9d  %.3f\n", count, count * 6, pwlMaxError);
+        for (i = 0; i < count; i++)
+        {
+            if (breakpoints[i].slope > 32767 || breakpoints[i].slope < -32767)
+            {
+                fprintf(stderr, "slope at code %d does not fit 16 bits\n", breakpoints[i].code);
+                return 1;
+            }
+        }
+        if (!output)
+        {
+            return 0;
+        }
+        out = fopen(output, "w");
+        if (!out)
+        {
+            perror(output);
+            return 1;
+        }
+        WriteBreakpoints(out, &model, breakpoints, count, pwlError);
+        fclose(out);
+        return 0;
+    }
+
+    printf("step  entries  ROM bytes  max delta  max error (degC)\n");
+    for (i = STEP_BITS_FIRST; i <= STEP_BITS_LAST; i++)
+    {
+        NTCTable *table = &tables[count++];
+
+        BuildTable(&model, i, table);
+        printf("%4d  %7d  %9d  %9d  %.3f%s\n", 1 << i, table->size, table->size * 2,
+               table->maxDelta, table->maxError,
+               ((long)table->maxDelta << i) > 65535 ? "  (too coarse for 16-bit interpolation)" : "");
+        if (((long)table->maxDelta << i) > 65535)
+        {
+            free(table->values);
+            count--;
+        }
+    }
+
+    // With an error budget keep only the coarsest table inside it
+    if (maxError > 0.0)
+    {
+        for (first = count - 1; first >= 0 && tables[first].maxError > maxError; first--)
+        {
+        }
+        if (first < 0)
+        {
+            fprintf(stderr, "no step meets a %.3f degC budget\n", maxError);
+            return 1;
+        }
+        printf("selected step %d (NTC_TABLE_STEP_BITS %d)\n", 1 << tables[first].stepBits, tables[first].stepBits);
+        count = 1;
+        stepBits = tables[first].stepBits;
+    }
+    else if (count == 0)
+    {
+        fprintf(stderr, "every step is too coarse for 16-bit interpolation\n");
+        return 1;
+    }
+    else
+    {
+        // The default step if it was kept, otherwise the coarsest one that was
+        stepBits = tables[count - 1].stepBits;
+        if (stepBits > STEP_BITS_DEFAULT)
+        {
+            stepBits = STEP_BITS_DEFAULT;
+        }
+    }
+
+    if (!output)
+    {
+        return 0;
+    }
+    out = fopen(output, "w");
+    if (!out)
+    {
+        perror(output);
+        return 1;
+    }
+    WriteHeader(out, &model, &tables[first], count, stepBits);
+    fclose(out);
+    return 0;
+}